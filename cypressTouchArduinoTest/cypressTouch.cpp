@@ -3,6 +3,14 @@
 
 // Macro helpers.
 #define GET_BOOTLOADERMODE(reg)		(((reg) & 0x10) >> 4)
+#define GET_BOOTLOADERBUSY(reg)		(((reg) & CYPRESS_TOUCH_BL_STATUS_BUSY) >> 7)
+
+// Default bootloader security keys.
+static const uint8_t _blDefaultKeys[] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+// I2C clocks used by the autotuning (fastest first). Index after the last one is CYPRESS_TOUCH_I2C_CLOCK_SAFE.
+static const uint32_t _i2cClocks[] = CYPRESS_TOUCH_I2C_CLOCKS;
+#define I2C_CLOCK_SAFE_INDEX        (sizeof(_i2cClocks) / sizeof(_i2cClocks[0]))
 
 /**
  * @brief Constructor for a new CypressTouch object.
@@ -10,7 +18,7 @@
  */
 CypressTouch::CypressTouch()
 {
-
+    memset(&_i2cStats, 0, sizeof(_i2cStats));
 }
 
 // Initialization function.
@@ -31,66 +39,139 @@ bool CypressTouch::begin(TwoWire *_touchI2C, Inkplate *_display)
     // Check for the null-pointer trap.
     if (_touchI2C == NULL || _display == NULL) return false;
 
-    // Copy library objects into the internal ones.
-    _displayPtr = _display;
-    _touchI2CPtr = _touchI2C;
-
-    // Initialize Wire library (just in case).
-    _touchI2CPtr->begin();
+    // Background init is still running.
+    if (_state == CYPRESS_TOUCH_STATE_STARTING) return false;
 
     // Set GPIO pins.
-    _displayPtr->pinModeIO(CYPRESS_TOUCH_PWR_MOS_PIN, OUTPUT, IO_INT_ADDR);
-    _displayPtr->pinModeIO(CYPRESS_TOUCH_RST_PIN, OUTPUT, IO_INT_ADDR);
+    initPins(_touchI2C, _display);
 
-    // Enable the power to the touch.
+    // Enable the power to the touch and do a HW reset.
     power(true);
-
-    // Do a HW reset.
     reset();
 
-    // Try to ping it.
-    if(!ping(5)) return false;
+    // Configure the Touchscreen Controller (clock autotuning included).
+    _i2cClockHold = false;
+    _state = CYPRESS_TOUCH_STATE_STARTING;
+    _state = bringUp() ? CYPRESS_TOUCH_STATE_READY : CYPRESS_TOUCH_STATE_FAILED;
 
-    // Issue a SW reset.
-    sendCommand(0x01);
+    return _state == CYPRESS_TOUCH_STATE_READY ? true : false;
+}
 
-    // Read bootloader data.
-    loadBootloaderRegs(&_blData);
+/**
+ * @brief       Start initialization in the background. Everything that uses the I/O expander (GPIO
+ *              pins, power up and HW reset, ~120ms) is done right away, because Inkplate library
+ *              uses the same I/O expander during the screen refresh. display.begin() must be called
+ *              before, it initializes the I/O expander. The rest of the init (ping, bootloader exit
+ *              and system info setup, most of the waiting) runs in the separate task, so display and
+ *              application init can run at the same time.
+ *              Use isReady(), waitReady() or the callback to find out when it's done. Until then,
+ *              available() and getTouchData() return false.
+ * 
+ * @param       TwoWire *_touchI2C
+ *              Arduino TwoWire object (I2C library). Needed for I2C Touch communication.
+ * @param       Inkplate *_display
+ *              Arduino Inkplate library - Needed for PCAL I/O expander for Power MOSFET enable for
+ *              Touchscreen power supply.
+ * @param       void (*_readyCb)(bool _ok, void *_arg)
+ *              Function called from the init task when init is done (NULL - not used). _ok is true if
+ *              the init was successful.
+ * @param       void *_arg
+ *              User argument passed to the callback.
+ * 
+ * @return      bool
+ *              true - Init task has been started.
+ *              false - Null-pointer, init is already running or task can't be created.
+ * 
+ * @note        Init task uses the same I2C bus as the display. If other tasks use Wire at the same time,
+ *              use setBus() before calling this. Init task doesn't change the I2C clock (setClock()
+ *              changes it for the whole bus while the display can be in the middle of a transfer), touch
+ *              works at the current Wire clock until the clock autotuning is done by the first
+ *              waitReady(), getTouchData() or setPowerMode() call after the init.
+ */
+bool CypressTouch::beginAsync(TwoWire *_touchI2C, Inkplate *_display, void (*_readyCb)(bool _ok, void *_arg), void *_arg)
+{
+    // Check for the null-pointer trap.
+    if (_touchI2C == NULL || _display == NULL) return false;
 
-    // Exit bootloader mode. - Does not exit bootloader propery!
-    if (!exitBootLoaderMode())
-    {
-        printError(&Serial, "Failed to exit bootloader mode");
-    }
+    // Background init is already running.
+    if (_state == CYPRESS_TOUCH_STATE_STARTING) return false;
 
-    // Set mode to system info mode.
-    if (!setSysInfoMode(&_sysData))
+    // Make the event group for waitReady() (only the first time).
+    if (_initEvent == NULL)
     {
-        printError(&Serial, "Failed to enter system info mode");
+        _initEvent = xEventGroupCreate();
+        if (_initEvent == NULL) return false;
     }
+    xEventGroupClearBits(_initEvent, CYPRESS_TOUCH_INIT_DONE_BIT);
 
-    // Set system info regs.
-    if (!setSysInfoRegs(&_sysData))
+    // Set GPIO pins, power up the touch and do a HW reset (I/O expander is not used after this).
+    initPins(_touchI2C, _display);
+    power(true);
+    reset();
+
+    // Start the rest of the init in the background (without touching the I2C clock).
+    this->_readyCb = _readyCb;
+    _readyArg = _arg;
+    _i2cClockHold = true;
+    _state = CYPRESS_TOUCH_STATE_STARTING;
+    if (xTaskCreatePinnedToCore(initTask, "cyTouchInit", CYPRESS_TOUCH_INIT_TASK_STACK, this, CYPRESS_TOUCH_INIT_TASK_PRIO, NULL, CYPRESS_TOUCH_INIT_TASK_CORE) != pdPASS)
     {
-        printError(&Serial, "Failed to enter system info registers");
+        _i2cClockHold = false;
+        _state = CYPRESS_TOUCH_STATE_FAILED;
+        return false;
     }
 
-    // Switch it into operate mode (also can be in deep sleep mode as well as low power mode).
-    sendCommand(CYPRESS_TOUCH_OPERATE_MODE);
+    return true;
+}
 
-    // Set dist value for detection?
-    uint8_t _distDefaultValue = 0xF8;
-    writeI2CRegs(0x1E, &_distDefaultValue, 1);
+/**
+ * @brief       Check if the Touchscreen Controller is initialized and ready.
+ * 
+ * @return      bool
+ *              true - Touchscreen Controller is ready.
+ *              false - Init is still running, has failed or has not been started.
+ */
+bool CypressTouch::isReady()
+{
+    return _state == CYPRESS_TOUCH_STATE_READY ? true : false;
+}
 
-    // Add interrupt callback.
-    pinMode(36, INPUT);
-    attachInterrupt(digitalPinToInterrupt(36), _touchscreenIntCallback, FALLING);
+/**
+ * @brief       Get Touchscreen Controller init state.
+ * 
+ * @return      uint8_t
+ *              CYPRESS_TOUCH_STATE_OFF, CYPRESS_TOUCH_STATE_STARTING, CYPRESS_TOUCH_STATE_READY or
+ *              CYPRESS_TOUCH_STATE_FAILED [defined in cypressTouch.h].
+ */
+uint8_t CypressTouch::getState()
+{
+    return _state;
+}
 
-    // Clear the interrpt flag.
-    _touchscreenIntFlag = false;
+/**
+ * @brief       Wait until the background initialization is done. I2C clock autotuning is done here
+ *              if the init has been successful.
+ * 
+ * @param       uint32_t _timeoutMs
+ *              Max. waiting time in milliseconds (portMAX_DELAY - wait forever).
+ * 
+ * @return      bool
+ *              true - Touchscreen Controller is ready.
+ *              false - Init has failed, has not been started or timeout.
+ */
+bool CypressTouch::waitReady(uint32_t _timeoutMs)
+{
+    // Wait only if the background init is running.
+    if (_state == CYPRESS_TOUCH_STATE_STARTING && _initEvent != NULL)
+    {
+        TickType_t _ticks = _timeoutMs == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(_timeoutMs);
+        xEventGroupWaitBits(_initEvent, CYPRESS_TOUCH_INIT_DONE_BIT, pdFALSE, pdTRUE, _ticks);
+    }
 
-    // Everything went ok? Return 1 for success.
-    return 1;
+    // Find the I2C clock (it's not done by the init task).
+    finishAsyncInit();
+
+    return isReady();
 }
 
 /**
@@ -104,6 +185,9 @@ bool CypressTouch::begin(TwoWire *_touchI2C, Inkplate *_display)
  */
 bool CypressTouch::available()
 {
+    // There is no touch data until the Touchscreen Controller is ready.
+    if (_state != CYPRESS_TOUCH_STATE_READY) return false;
+
     // Return the interrupt flag (interrrupt triggered - new touch data available).
     return _touchscreenIntFlag != 0?true:false;
 }
@@ -125,6 +209,12 @@ bool CypressTouch::getTouchData(struct cypressTouchData *_touchData)
     // Check for the null-pointer trap.
     if (_touchData == NULL) return false;
 
+    // Touchscreen Controller is not ready yet (background init is still running).
+    if (_state != CYPRESS_TOUCH_STATE_READY) return false;
+
+    // Find the I2C clock if the init has been done in the background.
+    finishAsyncInit();
+
     // Clear touch interrupt flag.
     _touchscreenIntFlag = false;
 
@@ -136,7 +226,9 @@ bool CypressTouch::getTouchData(struct cypressTouchData *_touchData)
 
     // Read registers for the touch data (32 bytes of data).
     // If read failed for some reason, return false.
+    uint32_t _readTimer = micros();
     if (!readI2CRegs(CYPRESS_TOUCH_BASE_ADDR, _regs, sizeof(_regs))) return false;
+    _i2cStats.reportReadTime = micros() - _readTimer;
 
     // Send a handshake.
     handshake();
@@ -173,6 +265,13 @@ bool CypressTouch::getTouchData(struct cypressTouchData *_touchData)
  */
 void CypressTouch::end()
 {
+    // Wait for the background init to finish first (it uses the same pins).
+    waitReady();
+
+    // Nothing to disable if init has never been started.
+    if (_displayPtr == NULL) return;
+    _state = CYPRESS_TOUCH_STATE_OFF;
+
     // Detach interrupt.
     detachInterrupt(36);
 
@@ -202,6 +301,12 @@ void CypressTouch::end()
  */
 bool CypressTouch::setPowerMode(uint8_t _powerMode)
 {
+    // Touchscreen Controller must be ready first.
+    if (_state != CYPRESS_TOUCH_STATE_READY) return false;
+
+    // Find the I2C clock if the init has been done in the background.
+    finishAsyncInit();
+
     // Check for the parameters.
     if ((_powerMode == CYPRESS_TOUCH_DEEP_SLEEP_MODE) || (_powerMode == CYPRESS_TOUCH_LOW_POWER_MODE) || (_powerMode == CYPRESS_TOUCH_OPERATE_MODE))
     {
@@ -258,6 +363,299 @@ void CypressTouch::scale(struct cypressTouchData *_touchData, uint16_t _xSize, u
     }
 }
 
+#if CYPRESS_TOUCH_USE_FW_UPDATE
+/**
+ * @brief       Update Touchscreen Controller firmware through the bootloader. Controller is put into
+ *              the bootloader, image is sent block by block (each block is checked by the bootloader)
+ *              and after that controller exits bootloader and it's initialized again with begin().
+ * 
+ * @param       const uint8_t *_fwImage
+ *              Pointer to the firmware image (raw application flash content, can be stored in flash).
+ * @param       uint32_t _len
+ *              Size of the firmware image in bytes.
+ * @param       uint16_t _firstBlock
+ *              Flash block number of the first block in the image.
+ * @param       void (*_progressCb)(uint16_t _block, uint16_t _totalBlocks)
+ *              Optional callback called after each written block (can be NULL).
+ * 
+ * @return      bool
+ *              true - Firmware is updated and Touchscreen Controller is initialized again.
+ *              false - Firmware update has failed.
+ * 
+ * @note        begin() must be called before this method. Blocks are sent one by one, the bootloader
+ *              NACKs every I2C transfer while it writes the block into the flash, so the next block
+ *              can't be sent (or even started) before the current one is done. Only the next packet is
+ *              built in RAM in that time, and the status is polled instead of waiting fixed delay
+ *              after each block.
+ */
+bool CypressTouch::updateFirmware(const uint8_t *_fwImage, uint32_t _len, uint16_t _firstBlock, void (*_progressCb)(uint16_t _block, uint16_t _totalBlocks))
+{
+    // Check for the null-pointer trap.
+    if (_fwImage == NULL || _len == 0 || _touchI2CPtr == NULL || _displayPtr == NULL) return false;
+
+    // Calculate the number of the blocks in the image.
+    uint16_t _totalBlocks = (_len + CYPRESS_TOUCH_BL_BLOCK_SIZE - 1) / CYPRESS_TOUCH_BL_BLOCK_SIZE;
+
+    // Two packet buffers, so the next packet can be built while the current block is written into the flash.
+    uint8_t _packets[2][CYPRESS_TOUCH_BL_BLOCK_SIZE + 15];
+    int _packetLen[2];
+
+    // Background init must be done first.
+    if (_state == CYPRESS_TOUCH_STATE_STARTING) return false;
+
+    // Touch reports are not valid during update, disable the interrupt.
+    _state = CYPRESS_TOUCH_STATE_OFF;
+    detachInterrupt(36);
+    _touchscreenIntFlag = false;
+
+    // Put the controller into bootloader mode.
+    if (!enterBootLoaderMode()) return false;
+
+    // Prepare the first packet.
+    _packetLen[0] = makeFirmwareBlockPacket(_packets[0], _firstBlock, _fwImage, _len);
+
+    for (uint16_t i = 0; i < _totalBlocks; i++)
+    {
+        // Current and next packet buffer.
+        uint8_t *_current = _packets[i & 1];
+        uint8_t *_next = _packets[(i + 1) & 1];
+
+        // Send the current block. Retry if the bootloader did not accept it.
+        int _retries = CYPRESS_TOUCH_BL_RETRIES;
+        bool _sent = writeI2CRegs(CYPRESS_TOUCH_BASE_ADDR, _current, _packetLen[i & 1]);
+
+        // While the controller writes the block into the flash (and NACKs everything), build the next packet in RAM.
+        if ((i + 1) < _totalBlocks)
+        {
+            uint32_t _offset = (uint32_t)(i + 1) * CYPRESS_TOUCH_BL_BLOCK_SIZE;
+            _packetLen[(i + 1) & 1] = makeFirmwareBlockPacket(_next, _firstBlock + i + 1, _fwImage + _offset, _len - _offset);
+        }
+
+        // Check the result of the current block, resend if needed. If the packet was not sent at all,
+        // block is not written even if the bootloader reports no error.
+        struct cyttspBootloaderData _bootloaderData;
+        bool _blockOk = waitBootLoaderReady(&_bootloaderData, CYPRESS_TOUCH_BL_TIMEOUT) && _sent && !(_bootloaderData.bl_error & CYPRESS_TOUCH_BL_ERROR_BAD_PKT);
+        while (!_blockOk && _retries-- > 0)
+        {
+            _blockOk = writeFirmwareBlock(_current, _packetLen[i & 1]);
+        }
+
+        // Block write failed? Stop here, controller stays in bootloader.
+        if (!_blockOk) return false;
+
+        // Report the progress.
+        if (_progressCb != NULL) _progressCb(i + 1, _totalBlocks);
+    }
+
+    // Image written, initialize the Touchscreen Controller again (this will also exit the bootloader).
+    return begin(_touchI2CPtr, _displayPtr);
+}
+#endif
+
+#if CYPRESS_TOUCH_KEEP_CHIP_INFO
+/**
+ * @brief       Get bootloader registers read during the init (only in diagnostic profile).
+ * 
+ * @param       struct cyttspBootloaderData *_blDataPtr
+ *              Defined in cypressTouchTypedefs.h, registers will be copied here.
+ */
+void CypressTouch::getBootloaderData(struct cyttspBootloaderData *_blDataPtr)
+{
+    if (_blDataPtr != NULL) memcpy(_blDataPtr, &_blData, sizeof(struct cyttspBootloaderData));
+}
+
+/**
+ * @brief       Get system info registers read during the init (only in diagnostic profile).
+ * 
+ * @param       struct cyttspSysinfoData *_sysDataPtr
+ *              Defined in cypressTouchTypedefs.h, registers will be copied here.
+ */
+void CypressTouch::getSysInfoData(struct cyttspSysinfoData *_sysDataPtr)
+{
+    if (_sysDataPtr != NULL) memcpy(_sysDataPtr, &_sysData, sizeof(struct cyttspSysinfoData));
+}
+#endif
+
+/**
+ * @brief       Use I2C bus arbiter for all Touchscreen Controller and I/O expander transfers. Touch
+ *              library is registered as the bus client with the highest priority
+ *              (CYPRESS_TOUCH_BUS_PRIO_TOUCH), so touch report reads go first.
+ * 
+ * @param       CypressTouchBus *_bus
+ *              Already initialized I2C bus arbiter (it must use the same Wire object).
+ * 
+ * @return      bool
+ *              true - Bus arbiter is used.
+ *              false - Null-pointer or there is no free bus client slot.
+ * 
+ * @note        Call it before begin(). Inkplate library itself does not use the arbiter, so display
+ *              code running in another task must lock the bus with its own client.
+ */
+bool CypressTouch::setBus(CypressTouchBus *_bus)
+{
+    // Check for the null-pointer trap.
+    if (_bus == NULL) return false;
+
+    // Register touch as the bus client.
+    int _client = _bus->addClient("touch", CYPRESS_TOUCH_BUS_PRIO_TOUCH);
+    if (_client < 0) return false;
+
+    _busPtr = _bus;
+    _busClient = _client;
+
+    return true;
+}
+
+/**
+ * @brief       Get currently used I2C clock.
+ * 
+ * @return      uint32_t
+ *              I2C clock in Hz.
+ */
+uint32_t CypressTouch::getI2CClock()
+{
+    return _i2cStats.clock;
+}
+
+/**
+ * @brief       Get I2C bus statistics - used clock, number of transfers, errors, how many times
+ *              clock has been lowered because of the errors and transfer times.
+ * 
+ * @param       struct cypressTouchI2CStats *_stats
+ *              Defined in cypressTouchTypedefs.h, statistics will be copied here.
+ */
+void CypressTouch::getI2CStats(struct cypressTouchI2CStats *_stats)
+{
+    // Check for the null-pointer trap.
+    if (_stats == NULL) return;
+
+    memcpy(_stats, &_i2cStats, sizeof(struct cypressTouchI2CStats));
+}
+
+/**
+ * @brief       Set I2C and I/O expander pins used by the Touchscreen Controller.
+ * 
+ * @param       TwoWire *_touchI2C
+ *              Arduino TwoWire object (I2C library).
+ * @param       Inkplate *_display
+ *              Arduino Inkplate library (for the PCAL I/O expander).
+ */
+void CypressTouch::initPins(TwoWire *_touchI2C, Inkplate *_display)
+{
+    // Copy library objects into the internal ones.
+    _displayPtr = _display;
+    _touchI2CPtr = _touchI2C;
+
+    // Initialize Wire library (just in case).
+    _touchI2CPtr->begin();
+
+    // Set GPIO pins.
+    busLock();
+    _displayPtr->pinModeIO(CYPRESS_TOUCH_PWR_MOS_PIN, OUTPUT, IO_INT_ADDR);
+    _displayPtr->pinModeIO(CYPRESS_TOUCH_RST_PIN, OUTPUT, IO_INT_ADDR);
+    busUnlock();
+}
+
+/**
+ * @brief       Configure already powered up Touchscreen Controller and attach the interrupt. This is
+ *              the slow part of the init (it's called from begin() or from the init task). It only
+ *              uses the Touchscreen Controller I2C address, not the I/O expander.
+ * 
+ * @return      bool
+ *              true - Touchscreen Controller is ready.
+ *              false - Touchscreen Controller init failed.
+ */
+bool CypressTouch::bringUp()
+{
+    // Try to ping it.
+    if(!ping(5)) return false;
+
+    // Find the fastest I2C clock Touchscreen Controller can work with (background init leaves it for later).
+    if (!_i2cClockHold) autotuneI2CClock();
+
+    // Issue a SW reset.
+    sendCommand(0x01);
+
+#if CYPRESS_TOUCH_KEEP_CHIP_INFO
+    // Bootloader and system info registers are kept for the diagnostic.
+    struct cyttspBootloaderData *_blDataPtr = &_blData;
+    struct cyttspSysinfoData *_sysDataPtr = &_sysData;
+#else
+    // Bootloader and system info registers are only needed during the init.
+    struct cyttspBootloaderData _blDataLocal;
+    struct cyttspSysinfoData _sysDataLocal;
+    struct cyttspBootloaderData *_blDataPtr = &_blDataLocal;
+    struct cyttspSysinfoData *_sysDataPtr = &_sysDataLocal;
+#endif
+
+    // Read bootloader data.
+    loadBootloaderRegs(_blDataPtr);
+
+    // Exit bootloader mode. - Does not exit bootloader propery!
+    if (!exitBootLoaderMode())
+    {
+        printDebug(&Serial, "Failed to exit bootloader mode");
+        return false;
+    }
+
+    // Set mode to system info mode.
+    if (!setSysInfoMode(_sysDataPtr))
+    {
+        printDebug(&Serial, "Failed to enter system info mode");
+        return false;
+    }
+
+    // Set system info regs.
+    if (!setSysInfoRegs(_sysDataPtr))
+    {
+        printDebug(&Serial, "Failed to enter system info registers");
+        return false;
+    }
+
+    // Switch it into operate mode (also can be in deep sleep mode as well as low power mode).
+    sendCommand(CYPRESS_TOUCH_OPERATE_MODE);
+
+    // Set dist value for detection?
+    uint8_t _distDefaultValue = 0xF8;
+    writeI2CRegs(0x1E, &_distDefaultValue, 1);
+
+    // Add interrupt callback.
+    pinMode(36, INPUT);
+    attachInterrupt(digitalPinToInterrupt(36), _touchscreenIntCallback, FALLING);
+
+    // Clear the interrpt flag.
+    _touchscreenIntFlag = false;
+
+    // Everything went ok? Return true for success.
+    return true;
+}
+
+/**
+ * @brief       Background init task. It runs bringUp(), sets the state, signals waitReady() and calls
+ *              the user callback. Task deletes itself when it's done.
+ * 
+ * @param       void *_arg
+ *              CypressTouch object pointer.
+ */
+void CypressTouch::initTask(void *_arg)
+{
+    CypressTouch *_touch = (CypressTouch*)_arg;
+
+    // Do the slow part of the init.
+    bool _ok = _touch->bringUp();
+    _touch->_state = _ok ? CYPRESS_TOUCH_STATE_READY : CYPRESS_TOUCH_STATE_FAILED;
+
+    // Clock can't be tuned if the init has failed.
+    if (!_ok) _touch->_i2cClockHold = false;
+
+    // Let everybody know init is done.
+    xEventGroupSetBits(_touch->_initEvent, CYPRESS_TOUCH_INIT_DONE_BIT);
+    if (_touch->_readyCb != NULL) _touch->_readyCb(_ok, _touch->_readyArg);
+
+    // Delete this task.
+    vTaskDelete(NULL);
+}
+
 /**
  * @brief       Enable or disable power to the Touchscreen Controller.
  * 
@@ -271,13 +669,13 @@ void CypressTouch::power(bool _pwr)
     if (_pwr)
     {
         // Enable the power MOSFET.
-        _displayPtr->digitalWriteIO(CYPRESS_TOUCH_PWR_MOS_PIN, HIGH, IO_INT_ADDR);
+        writeIO(CYPRESS_TOUCH_PWR_MOS_PIN, HIGH);
 
         // Wait a little bit before proceeding any further.
         delay(50);
 
         // Set reset pin to high.
-        _displayPtr->digitalWriteIO(CYPRESS_TOUCH_RST_PIN, HIGH, IO_INT_ADDR);
+        writeIO(CYPRESS_TOUCH_RST_PIN, HIGH);
 
         // Wait a little bit.
         delay(50);
@@ -285,16 +683,32 @@ void CypressTouch::power(bool _pwr)
     else
     {
         // Disable the power MOSFET switch.
-        _displayPtr->digitalWriteIO(CYPRESS_TOUCH_PWR_MOS_PIN, LOW, IO_INT_ADDR);
+        writeIO(CYPRESS_TOUCH_PWR_MOS_PIN, LOW);
 
         // Wait a bit to discharge caps.
         delay(50);
 
         // Set reset pin to low.
-        _displayPtr->digitalWriteIO(CYPRESS_TOUCH_RST_PIN, LOW, IO_INT_ADDR);
+        writeIO(CYPRESS_TOUCH_RST_PIN, LOW);
     }
 }
 
+/**
+ * @brief       Set I/O expander pin state. I/O expander is on the same I2C bus, so the bus is locked
+ *              if bus arbiter is used.
+ * 
+ * @param       uint8_t _pin
+ *              I/O expander pin.
+ * @param       uint8_t _state
+ *              HIGH or LOW.
+ */
+void CypressTouch::writeIO(uint8_t _pin, uint8_t _state)
+{
+    busLock();
+    _displayPtr->digitalWriteIO(_pin, _state, IO_INT_ADDR);
+    busUnlock();
+}
+
 /**
  * @brief       Method does a HW reset by using RST pin on the Touchscreen/Touchscreen Controller.
  * 
@@ -302,11 +716,11 @@ void CypressTouch::power(bool _pwr)
 void CypressTouch::reset()
 {
     // Toggle RST line. Loggic low must be at least 1ms, re-init after reset not specified, 10 ms (from Linux kernel).
-    _displayPtr->digitalWriteIO(CYPRESS_TOUCH_RST_PIN, HIGH, IO_INT_ADDR);
+    writeIO(CYPRESS_TOUCH_RST_PIN, HIGH);
     delay(10);
-    _displayPtr->digitalWriteIO(CYPRESS_TOUCH_RST_PIN, LOW, IO_INT_ADDR);
+    writeIO(CYPRESS_TOUCH_RST_PIN, LOW);
     delay(2);
-    _displayPtr->digitalWriteIO(CYPRESS_TOUCH_RST_PIN, HIGH, IO_INT_ADDR);
+    writeIO(CYPRESS_TOUCH_RST_PIN, HIGH);
     delay(10);
 }
 
@@ -363,9 +777,9 @@ bool CypressTouch::exitBootLoaderMode()
     // Bootloader command array.
     uint8_t _blCommandArry[] = 
     {
-        0x00,   // File offset.
-        0xFF,   // Command.
-        0xA5,   // Exit bootloader command.
+        0x00,                       // File offset.
+        CYPRESS_TOUCH_BL_CMD,       // Command.
+        CYPRESS_TOUCH_BL_EXIT,      // Exit bootloader command.
         0, 1, 2, 3, 4, 5, 6, 7  // Default keys.
     };
 
@@ -387,6 +801,166 @@ bool CypressTouch::exitBootLoaderMode()
     return true;
 }
 
+#if CYPRESS_TOUCH_USE_FW_UPDATE
+/**
+ * @brief       Method forces Touchscreen Controller into bootloader mode. Controller stays in the
+ *              bootloader after the reset, so HW reset is done first and enter command is only sent
+ *              if the running firmware did not stay in the bootloader.
+ * 
+ * @return      bool
+ *              true - Touchscreen Controller is in bootloader mode and ready for the block writes.
+ *              false - Touchscreen Controller failed to enter bootloader mode.
+ */
+bool CypressTouch::enterBootLoaderMode()
+{
+    // Do a HW reset, controller should stay in the bootloader until exit command is received.
+    reset();
+
+    // Get bootloader data.
+    struct cyttspBootloaderData _bootloaderData;
+    if (!loadBootloaderRegs(&_bootloaderData)) return false;
+
+    // Still in the application? Send enter bootloader command.
+    if (!GET_BOOTLOADERMODE(_bootloaderData.bl_status))
+    {
+        uint8_t _blCommandArry[3 + sizeof(_blDefaultKeys)] =
+        {
+            0x00,                       // File offset.
+            CYPRESS_TOUCH_BL_CMD,       // Command.
+            CYPRESS_TOUCH_BL_ENTER,     // Enter bootloader command.
+        };
+        memcpy(_blCommandArry + 3, _blDefaultKeys, sizeof(_blDefaultKeys));
+
+        if (!writeI2CRegs(CYPRESS_TOUCH_BASE_ADDR, _blCommandArry, sizeof(_blCommandArry))) return false;
+    }
+
+    // Wait for the bootloader to get ready.
+    if (!waitBootLoaderReady(&_bootloaderData, CYPRESS_TOUCH_BL_TIMEOUT)) return false;
+
+    // Check if the bootloader is really running.
+    return GET_BOOTLOADERMODE(_bootloaderData.bl_status) ? true : false;
+}
+
+/**
+ * @brief       Method fills the bootloader block write packet. Packet goes as follows:
+ *              [1 byte] File offset (0x00).
+ *              [1 byte] Command (0xFF).
+ *              [1 byte] Write block command (0x39).
+ *              [8 bytes] Security keys.
+ *              [2 bytes] Block number (MSB first).
+ *              [64 bytes] Block data (padded with 0xFF if shorter).
+ *              [2 bytes] Checksum - 16 bit sum of the block data (MSB first).
+ * 
+ * @param       uint8_t *_packet
+ *              Buffer for the packet. Must be at least CYPRESS_TOUCH_BL_BLOCK_SIZE + 15 bytes long.
+ * @param       uint16_t _blockNum
+ *              Flash block number.
+ * @param       const uint8_t *_data
+ *              Pointer to the block data in the firmware image.
+ * @param       int _len
+ *              Number of bytes left in the firmware image for this block.
+ * 
+ * @return      int
+ *              Packet length in bytes.
+ */
+int CypressTouch::makeFirmwareBlockPacket(uint8_t *_packet, uint16_t _blockNum, const uint8_t *_data, int _len)
+{
+    // Packet index.
+    int _index = 0;
+
+    // Checksum of the block data.
+    uint16_t _checksum = 0;
+
+    // File offset, command, write block command and keys.
+    _packet[_index++] = 0x00;
+    _packet[_index++] = CYPRESS_TOUCH_BL_CMD;
+    _packet[_index++] = CYPRESS_TOUCH_BL_WRITE_BLOCK;
+    memcpy(_packet + _index, _blDefaultKeys, sizeof(_blDefaultKeys));
+    _index += sizeof(_blDefaultKeys);
+
+    // Block number.
+    _packet[_index++] = _blockNum >> 8;
+    _packet[_index++] = _blockNum & 0xFF;
+
+    // Block data. Last block in the image can be shorter, pad it with erased flash value.
+    for (int i = 0; i < CYPRESS_TOUCH_BL_BLOCK_SIZE; i++)
+    {
+        uint8_t _byte = i < _len ? _data[i] : 0xFF;
+        _packet[_index++] = _byte;
+        _checksum += _byte;
+    }
+
+    // Checksum.
+    _packet[_index++] = _checksum >> 8;
+    _packet[_index++] = _checksum & 0xFF;
+
+    // Return the packet length.
+    return _index;
+}
+
+/**
+ * @brief       Method sends one block write packet to the bootloader and checks if the bootloader
+ *              accepted it.
+ * 
+ * @param       uint8_t *_packet
+ *              Packet made by makeFirmwareBlockPacket().
+ * @param       int _len
+ *              Packet length.
+ * 
+ * @return      bool
+ *              true - Block is written and verified by the bootloader.
+ *              false - Block write has failed (I2C error, timeout or checksum error).
+ */
+bool CypressTouch::writeFirmwareBlock(uint8_t *_packet, int _len)
+{
+    // Bootloader register data.
+    struct cyttspBootloaderData _bootloaderData;
+
+    // Send the packet (file offset is the register address).
+    if (!writeI2CRegs(CYPRESS_TOUCH_BASE_ADDR, _packet, _len)) return false;
+
+    // Poll the status until flash write is done.
+    if (!waitBootLoaderReady(&_bootloaderData, CYPRESS_TOUCH_BL_TIMEOUT)) return false;
+
+    // Bootloader checks the block checksum, bad packet bit is set if it does not match.
+    return (_bootloaderData.bl_error & CYPRESS_TOUCH_BL_ERROR_BAD_PKT) ? false : true;
+}
+
+/**
+ * @brief       Method polls bootloader status register until bootloader is not busy anymore.
+ * 
+ * @param       struct cyttspBootloaderData *_blDataPtr
+ *              Defined in cypressTouchTypedefs.h, last read bootloader registers will be stored here.
+ * @param       uint32_t _timeout
+ *              Timeout in milliseconds.
+ * 
+ * @return      bool
+ *              true - Bootloader is ready.
+ *              false - Bootloader is still busy after timeout or I2C read failed.
+ */
+bool CypressTouch::waitBootLoaderReady(struct cyttspBootloaderData *_blDataPtr, uint32_t _timeout)
+{
+    // Capture the time when polling started.
+    unsigned long _timer = millis();
+
+    do
+    {
+        // Read the bootloader registers. Controller can NACK while it's writing into the flash, so just
+        // retry (these NACKs must not lower the I2C clock).
+        _i2cExpectNack = true;
+        bool _ok = loadBootloaderRegs(_blDataPtr);
+        _i2cExpectNack = false;
+        if (_ok && !GET_BOOTLOADERBUSY(_blDataPtr->bl_status)) return true;
+
+        // Poll often, flash block write takes only few milliseconds.
+        delay(1);
+    } while ((unsigned long)(millis() - _timer) < _timeout);
+
+    // Got here? Timeout.
+    return false;
+}
+#endif
+
 /**
  * @brief       Set Touchscreen Controller into System Info mode.
  * 
@@ -472,10 +1046,13 @@ bool CypressTouch::setSysInfoRegs(struct cyttspSysinfoData *_sysDataPtr)
 void CypressTouch::handshake()
 {
     // Read the hst_mode register (address 0x00).
+    // Keep the bus locked, nobody should get between read and write.
+    busLock();
     uint8_t _hstModeReg = 0;
     readI2CRegs(CYPRESS_TOUCH_BASE_ADDR, &_hstModeReg, 1);
     _hstModeReg ^= 0x80;
     writeI2CRegs(CYPRESS_TOUCH_BASE_ADDR, &_hstModeReg, 1);
+    busUnlock();
 }
 
 bool CypressTouch::ping(int _retries)
@@ -488,8 +1065,10 @@ bool CypressTouch::ping(int _retries)
     for (int i = 0; i < _retries; i++)
     {
         // Ping the TSC (touchscreen controller) on I2C.
+        busLock();
         _touchI2CPtr->beginTransmission(CPYRESS_TOUCH_I2C_ADDR);
         _retValue = _touchI2CPtr->endTransmission();
+        busUnlock();
 
         // Return value is 0? That means ACK, TSC found!
         if (_retValue == 0)
@@ -505,41 +1084,56 @@ bool CypressTouch::ping(int _retries)
     return false;
 }
 
-// Needs to be removed.
+#if CYPRESS_TOUCH_USE_REG_DUMP
+/**
+ * @brief       Print Touchscreen Controller registers on the serial (only in diagnostic profile).
+ * 
+ * @param       HardwareSerial *_debugSerialPtr
+ *              Pointer to the Serial object.
+ * @param       int _startAddress
+ *              First register address.
+ * @param       int _endAddress
+ *              End register address, not included (max. 32 registers can be read).
+ */
 void CypressTouch::regDump(HardwareSerial *_debugSerialPtr, int _startAddress, int _endAddress)
 {
-    // Check the size of the request. Reading more than 32 bytes over I2C is not possible.
-    int _len = abs(_endAddress - _startAddress);
-    if (_len > 32)
-    {
-        printDebug(_debugSerialPtr, "Reading more than 32 bytes over I2C on Arduino is not possible");
-    }
-
     // Check for order.
     if (_startAddress > _endAddress)
     {
         // Swap them!
         int _temp = _startAddress;
         _startAddress = _endAddress;
-        _endAddress = _startAddress;
+        _endAddress = _temp;
         printInfo(_debugSerialPtr, "Start and end I2C register address are swapped");
     }
 
-    // Make a request!
-    _touchI2CPtr->beginTransmission(CPYRESS_TOUCH_I2C_ADDR);
-    _touchI2CPtr->write(_startAddress);
-    _touchI2CPtr->endTransmission();
-    _touchI2CPtr->requestFrom(CPYRESS_TOUCH_I2C_ADDR, _len);
+    // Check the size of the request. Reading more than 32 bytes over I2C is not possible.
+    int _len = _endAddress - _startAddress;
+    if (_len > 32)
+    {
+        printDebug(_debugSerialPtr, "Reading more than 32 bytes over I2C on Arduino is not possible");
+        _len = 32;
+    }
+
+    // Make a request! Use the same read as everything else (bus lock and I2C statistics).
+    uint8_t _regs[32];
+    if (!readI2CRegs(_startAddress, _regs, _len))
+    {
+        printDebug(_debugSerialPtr, "Register read failed");
+        return;
+    }
     
     // Print them!
-    for (int i = _startAddress; i < _endAddress; i++)
+    for (int i = 0; i < _len; i++)
     {
         char _tempArray[40];
-        sprintf(_tempArray, "REG 0x%02X, Value: 0x%02X", i, _touchI2CPtr->read());
+        sprintf(_tempArray, "REG 0x%02X, Value: 0x%02X", _startAddress + i, _regs[i]);
         printDebug(_debugSerialPtr, _tempArray);
     }
 }
+#endif
 
+#if CYPRESS_TOUCH_USE_PRINT
 /**
  * @brief       Prints out a debug message on the selected serial class.
  * 
@@ -552,8 +1146,11 @@ void CypressTouch::regDump(HardwareSerial *_debugSerialPtr, int _startAddress, i
  */
 void CypressTouch::printMessage(HardwareSerial *_serial, char *_msgPrefix, char *_message)
 {
+#if CYPRESS_TOUCH_USE_TIMESTAMP
     printTimestamp(_serial);
-    _serial->print(" - [");
+    _serial->print(" - ");
+#endif
+    _serial->print("[");
     _serial->print(_msgPrefix);
     _serial->print("]: ");
     _serial->print(_message);
@@ -613,6 +1210,9 @@ void CypressTouch::printError(HardwareSerial *_serial, char *_message)
     }
 }
 
+#endif
+
+#if CYPRESS_TOUCH_USE_TIMESTAMP
 /**
  * @brief       Helper function for the printing timestamp on the serial.
  *              Timestamp source is Arduino millis() function.
@@ -630,9 +1230,156 @@ void CypressTouch::printTimestamp(HardwareSerial *_serial)
     int _ms = _millisCapture % 1000ULL;
     _serial->printf("%02d:%02d:%02d;%03d", _h, _m, _s, _ms);
 }
+#endif
 
 // -----------------------------LOW level I2C functions-----------------------------
 
+/**
+ * @brief       Lock the I2C bus before the transfer (only if bus arbiter is used).
+ * 
+ */
+void CypressTouch::busLock()
+{
+    if (_busPtr != NULL) _busPtr->lock(_busClient);
+}
+
+/**
+ * @brief       Unlock the I2C bus after the transfer (only if bus arbiter is used).
+ * 
+ */
+void CypressTouch::busUnlock()
+{
+    if (_busPtr != NULL) _busPtr->unlock(_busClient);
+}
+
+/**
+ * @brief       Method finds the fastest I2C clock that Touchscreen Controller can work with. Registers
+ *              are read at the safe clock first and then read multiple times at each faster clock.
+ *              Clock is used only if all reads are successfull and data matches.
+ * 
+ * @return      bool
+ *              true - Faster clock is found.
+ *              false - None of the faster clocks work, safe clock is used.
+ * 
+ * @note        Wire is shared with I/O expander, so all devices on the bus must support selected clock.
+ */
+bool CypressTouch::autotuneI2CClock()
+{
+    // Reference register data read at the safe clock.
+    uint8_t _refRegs[16];
+    setI2CClock(I2C_CLOCK_SAFE_INDEX);
+    if (!readI2CRegs(CYPRESS_TOUCH_BASE_ADDR, _refRegs, sizeof(_refRegs))) return false;
+
+    for (uint8_t i = 0; i < I2C_CLOCK_SAFE_INDEX; i++)
+    {
+        // Try this clock.
+        setI2CClock(i);
+
+        // Read the registers multiple times and compare them with the reference.
+        int j = 0;
+        for (; j < CYPRESS_TOUCH_I2C_PROBE_READS; j++)
+        {
+            uint8_t _regs[sizeof(_refRegs)];
+            if (!readI2CRegs(CYPRESS_TOUCH_BASE_ADDR, _regs, sizeof(_regs))) break;
+            if (memcmp(_regs, _refRegs, sizeof(_regs)) != 0) break;
+        }
+
+        // All reads ok? Use this clock.
+        if (j == CYPRESS_TOUCH_I2C_PROBE_READS) return true;
+    }
+
+    // Got here? Use the safe clock.
+    setI2CClock(I2C_CLOCK_SAFE_INDEX);
+    return false;
+}
+
+/**
+ * @brief       Do the I2C clock autotuning left out by the background init. It's called from the
+ *              application task (waitReady(), getTouchData(), setPowerMode()), so the clock is not
+ *              changed while that task uses Wire for something else (like the display).
+ * 
+ */
+void CypressTouch::finishAsyncInit()
+{
+    // Nothing to do (synchronous init or already done) or init is not done yet.
+    if (!_i2cClockHold || _state != CYPRESS_TOUCH_STATE_READY) return;
+
+    _i2cClockHold = false;
+    autotuneI2CClock();
+}
+
+/**
+ * @brief       Set I2C clock from the list of the supported clocks and clear the error window.
+ * 
+ * @param       uint8_t _index
+ *              Index in CYPRESS_TOUCH_I2C_CLOCKS list (or the index after the last for the safe clock).
+ */
+void CypressTouch::setI2CClock(uint8_t _index)
+{
+    // Background init is running, other tasks can use Wire without the bus arbiter.
+    if (_i2cClockHold) return;
+
+    _i2cClockIndex = _index < I2C_CLOCK_SAFE_INDEX ? _index : I2C_CLOCK_SAFE_INDEX;
+    _i2cStats.clock = _i2cClockIndex < I2C_CLOCK_SAFE_INDEX ? _i2cClocks[_i2cClockIndex] : CYPRESS_TOUCH_I2C_CLOCK_SAFE;
+
+    // Clock is changed for the whole bus, so don't change it in the middle of other client's transfer.
+    busLock();
+    _touchI2CPtr->setClock(_i2cStats.clock);
+    busUnlock();
+
+    // Start new error window.
+    _i2cWindowTransfers = 0;
+    _i2cWindowErrors = 0;
+}
+
+/**
+ * @brief       Method updates I2C statistics after each transfer. If there are too many errors in
+ *              the error window, next slower I2C clock is used. Expected NACKs (_i2cExpectNack) are
+ *              not counted as errors.
+ * 
+ * @param       bool _ok
+ *              Result of the transfer.
+ * @param       uint32_t _startTime
+ *              Time when the transfer has started (micros()).
+ * 
+ * @return      bool
+ *              Result of the transfer (_ok), so it can be returned directly.
+ */
+bool CypressTouch::i2cTransferDone(bool _ok, uint32_t _startTime)
+{
+    // Update the transfer times.
+    uint32_t _time = micros() - _startTime;
+    _i2cStats.lastTransferTime = _time;
+    if (_time > _i2cStats.maxTransferTime) _i2cStats.maxTransferTime = _time;
+    _i2cStats.transfers++;
+
+    // Expected NACK (for example busy bootloader)? It's not an I2C error.
+    if (!_ok && _i2cExpectNack) return _ok;
+
+    _i2cWindowTransfers++;
+
+    if (!_ok)
+    {
+        _i2cStats.errors++;
+        _i2cWindowErrors++;
+    }
+
+    if (_i2cWindowErrors > CYPRESS_TOUCH_I2C_ERR_LIMIT && _i2cClockIndex < I2C_CLOCK_SAFE_INDEX && !_i2cClockHold)
+    {
+        // Too many errors, fall back to slower clock.
+        setI2CClock(_i2cClockIndex + 1);
+        _i2cStats.fallbacks++;
+    }
+    else if (_i2cWindowTransfers >= CYPRESS_TOUCH_I2C_ERR_WINDOW)
+    {
+        // Start new error window.
+        _i2cWindowTransfers = 0;
+        _i2cWindowErrors = 0;
+    }
+
+    return _ok;
+}
+
 /**
  * @brief       Method sends I2C command to the Touchscreen Controller IC.
  * 
@@ -644,7 +1391,12 @@ void CypressTouch::printTimestamp(HardwareSerial *_serial)
  */
 bool CypressTouch::sendCommand(uint8_t _cmd)
 {
+    // Wait a little bit (before locking the bus, so other bus clients are not blocked).
+    delay(20);
+
     // Init I2C communication.
+    busLock();
+    uint32_t _startTime = micros();
     _touchI2CPtr->beginTransmission(CPYRESS_TOUCH_I2C_ADDR);
     
     // I'm not sure about this?
@@ -654,11 +1406,11 @@ bool CypressTouch::sendCommand(uint8_t _cmd)
     // Write command.
     _touchI2CPtr->write(_cmd);
 
-    // Wait a little bit.
-    delay(20);
-
-    // Send to I2C!
-    return _touchI2CPtr->endTransmission() == 0?true:false;
+    // Send to I2C! Unlock the bus after the statistics update, it can change the I2C clock.
+    bool _ret = _touchI2CPtr->endTransmission() == 0?true:false;
+    _ret = i2cTransferDone(_ret, _startTime);
+    busUnlock();
+    return _ret;
 }
 
 /**
@@ -679,6 +1431,10 @@ bool CypressTouch::sendCommand(uint8_t _cmd)
  */
 bool CypressTouch::readI2CRegs(uint8_t _cmd, uint8_t *_buffer, int _len)
 {
+    // Lock the bus and capture the time for the transfer statistics (without the time spent waiting for the bus).
+    busLock();
+    uint32_t _startTime = micros();
+
     // Init I2C communication!
     _touchI2CPtr->beginTransmission(CPYRESS_TOUCH_I2C_ADDR);
 
@@ -689,6 +1445,8 @@ bool CypressTouch::readI2CRegs(uint8_t _cmd, uint8_t *_buffer, int _len)
     // Write reg to the I2C! If I2C send has failed, return false.
     if (_touchI2CPtr->endTransmission() != 0)
     {
+        i2cTransferDone(false, _startTime);
+        busUnlock();
         return false;
     }
 
@@ -700,8 +1458,13 @@ bool CypressTouch::readI2CRegs(uint8_t _cmd, uint8_t *_buffer, int _len)
         // Check for the size of the remaining buffer.
         int _i2cLen = _len > 32?32:_len;
 
-        // Read the bytes from the I2C.
-        _touchI2CPtr->requestFrom(CPYRESS_TOUCH_I2C_ADDR, _i2cLen);
+        // Read the bytes from the I2C. If less bytes are received, read has failed (NACK or timeout).
+        if (_touchI2CPtr->requestFrom(CPYRESS_TOUCH_I2C_ADDR, _i2cLen) != _i2cLen)
+        {
+            i2cTransferDone(false, _startTime);
+            busUnlock();
+            return false;
+        }
         _touchI2CPtr->readBytes(_buffer + _index, _i2cLen);
         
         // Update the buffer index position.
@@ -711,7 +1474,9 @@ bool CypressTouch::readI2CRegs(uint8_t _cmd, uint8_t *_buffer, int _len)
         _len -= _i2cLen;
     }
 
-    // Everything went ok? Return true.
+    // Everything went ok? Return true (unlock the bus after the statistics update, it can change the I2C clock).
+    i2cTransferDone(true, _startTime);
+    busUnlock();
     return true;
 }
 
@@ -733,6 +1498,10 @@ bool CypressTouch::readI2CRegs(uint8_t _cmd, uint8_t *_buffer, int _len)
  */
 bool CypressTouch::writeI2CRegs(uint8_t _cmd, uint8_t *_buffer, int _len)
 {
+    // Lock the bus and capture the time for the transfer statistics (without the time spent waiting for the bus).
+    busLock();
+    uint32_t _startTime = micros();
+
     // Init I2C communication!
     _touchI2CPtr->beginTransmission(CPYRESS_TOUCH_I2C_ADDR);
 
@@ -746,9 +1515,13 @@ bool CypressTouch::writeI2CRegs(uint8_t _cmd, uint8_t *_buffer, int _len)
     // Write reg to the I2C! If I2C send has failed, return false.
     if (_touchI2CPtr->endTransmission() != 0)
     {
+        i2cTransferDone(false, _startTime);
+        busUnlock();
         return false;
     }
 
-    // Everything went ok? Return true.
+    // Everything went ok? Return true (unlock the bus after the statistics update, it can change the I2C clock).
+    i2cTransferDone(true, _startTime);
+    busUnlock();
     return true;
 }
@@ -16,9 +16,20 @@
 // Include Inkplate library (neded for GPIO manipulation).
 #include <Inkplate.h>
 
+// Include FreeRTOS tasks and event groups (needed for the background init).
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/event_groups.h>
+
 // Include Cypress touchscreen typedefs.
 #include "cypressTouchTypedefs.h"
 
+// Include build profile and feature selection.
+#include "cypressTouchConfig.h"
+
+// Include I2C bus arbiter (for sharing Wire with other tasks and devices).
+#include "cypressTouchBus.h"
+
 // Cypress Touch IC I2C address (7 bit I2C address).
 #define CPYRESS_TOUCH_I2C_ADDR  0x24
 
@@ -42,6 +53,55 @@
 // Touch timeout for the Active power */
 #define CYPRESS_TOUCH_TCH_TMOUT_DFLT		0xFF /* ms */
 
+// Bootloader commands. Command packet is written to the register 0x00 and goes as follows (same as bl_cmd
+// in the Linux cyttsp driver): [file offset 0x00] [0xFF] [command] [8 bytes security keys] [command data].
+#define CYPRESS_TOUCH_BL_CMD            0xFF
+#define CYPRESS_TOUCH_BL_ENTER          0x38
+#define CYPRESS_TOUCH_BL_WRITE_BLOCK    0x39
+#define CYPRESS_TOUCH_BL_EXIT           0xA5
+
+// Bootloader status and error bits (bl_status and bl_error registers).
+#define CYPRESS_TOUCH_BL_STATUS_BUSY    0x80
+#define CYPRESS_TOUCH_BL_STATUS_BLMODE  0x10
+#define CYPRESS_TOUCH_BL_ERROR_BAD_PKT  0x20
+
+// Size of one flash block in the bootloader write command.
+#define CYPRESS_TOUCH_BL_BLOCK_SIZE     64
+
+// How many times single block write is retried and how long to wait for the flash write (in ms).
+#define CYPRESS_TOUCH_BL_RETRIES        3
+#define CYPRESS_TOUCH_BL_TIMEOUT        100
+
+// I2C clock autotuning. Clocks from CYPRESS_TOUCH_I2C_CLOCKS are tried in begin() (fastest first),
+// CYPRESS_TOUCH_I2C_CLOCK_SAFE is used if none of them works. Clock is set for the whole bus, so
+// clocks above 400 kHz are used only with CYPRESS_TOUCH_I2C_FAST_PLUS (see cypressTouchConfig.h).
+#if CYPRESS_TOUCH_I2C_FAST_PLUS
+#define CYPRESS_TOUCH_I2C_CLOCKS        {1000000, 800000, 400000}
+#else
+#define CYPRESS_TOUCH_I2C_CLOCKS        {400000}
+#endif
+#define CYPRESS_TOUCH_I2C_CLOCK_SAFE    100000
+#define CYPRESS_TOUCH_I2C_PROBE_READS   20
+
+// If there is more than CYPRESS_TOUCH_I2C_ERR_LIMIT failed transfers in the last
+// CYPRESS_TOUCH_I2C_ERR_WINDOW transfers, I2C clock is switched to the next slower one.
+#define CYPRESS_TOUCH_I2C_ERR_WINDOW    64
+#define CYPRESS_TOUCH_I2C_ERR_LIMIT     2
+
+// Background init task (beginAsync()) stack size, priority and CPU core.
+#define CYPRESS_TOUCH_INIT_TASK_STACK   4096
+#define CYPRESS_TOUCH_INIT_TASK_PRIO    1
+#define CYPRESS_TOUCH_INIT_TASK_CORE    tskNO_AFFINITY
+
+// Touchscreen Controller init states.
+#define CYPRESS_TOUCH_STATE_OFF         0
+#define CYPRESS_TOUCH_STATE_STARTING    1
+#define CYPRESS_TOUCH_STATE_READY       2
+#define CYPRESS_TOUCH_STATE_FAILED      3
+
+// Event group bit set when the background init is done (successfully or not).
+#define CYPRESS_TOUCH_INIT_DONE_BIT     0x01
+
 // Max X and Y sizes reported by the TSC.
 #define CYPRESS_TOUCH_MAX_X     682
 #define CYPRESS_TOUCH_MAX_Y     1023
@@ -62,6 +122,18 @@ class CypressTouch
         // Initialization function.
         bool begin(TwoWire *_touchI2C, Inkplate *_display);
 
+        // Start initialization in the background task (returns right after the power up and HW reset).
+        bool beginAsync(TwoWire *_touchI2C, Inkplate *_display, void (*_readyCb)(bool _ok, void *_arg) = NULL, void *_arg = NULL);
+
+        // Check if the Touchscreen Controller is initialized and ready.
+        bool isReady();
+
+        // Get Touchscreen Controller init state.
+        uint8_t getState();
+
+        // Wait until the background initialization is done.
+        bool waitReady(uint32_t _timeoutMs = portMAX_DELAY);
+
         // Check if there is any new touch event detected.
         bool available();
 
@@ -77,6 +149,34 @@ class CypressTouch
         // Scale touch data report to fit screen (and also rotation).
         void scale(struct cypressTouchData *_touchData, uint16_t _xSize, uint16_t _ySize, bool _flipX, bool _flipY, bool _swapXY);
 
+#if CYPRESS_TOUCH_USE_FW_UPDATE
+        // Update Touchscreen Controller firmware through the bootloader.
+        bool updateFirmware(const uint8_t *_fwImage, uint32_t _len, uint16_t _firstBlock, void (*_progressCb)(uint16_t _block, uint16_t _totalBlocks) = NULL);
+#endif
+
+        // Use I2C bus arbiter for all Touchscreen Controller and I/O expander transfers.
+        bool setBus(CypressTouchBus *_bus);
+
+        // Get currently used I2C clock.
+        uint32_t getI2CClock();
+
+        // Get I2C bus statistics (clock, errors, transfer times).
+        void getI2CStats(struct cypressTouchI2CStats *_stats);
+
+#if CYPRESS_TOUCH_KEEP_CHIP_INFO
+        // Get bootloader registers read during the init.
+        void getBootloaderData(struct cyttspBootloaderData *_blDataPtr);
+
+        // Get system info registers read during the init.
+        void getSysInfoData(struct cyttspSysinfoData *_sysDataPtr);
+#endif
+
+#if CYPRESS_TOUCH_USE_REG_DUMP
+        // Print Touchscreen Controller registers on the serial.
+        void regDump(HardwareSerial *_debugSerialPtr, int _startAddress, int _endAddress);
+#endif
+
+#if CYPRESS_TOUCH_USE_PRINT
         // Helper function for printing info data on the serial (with [INFO] header and timestamp).
         void printInfo(HardwareSerial *_serial, char *_message);
 
@@ -85,6 +185,12 @@ class CypressTouch
 
         // Helper function for printig error messages to the serial (with [ERROR] header, timestamp and code halt).
         void printError(HardwareSerial *_serial, char *_message);
+#else
+        // Print helpers are disabled, nothing is printed (printError() still halts the code).
+        void printInfo(HardwareSerial *_serial, char *_message) {}
+        void printDebug(HardwareSerial *_serial, char *_message) {}
+        void printError(HardwareSerial *_serial, char *_message) { while (1) delay(100); }
+#endif
 
     private:
         // Inkplate library internal object pointer.
@@ -93,15 +199,59 @@ class CypressTouch
         // I2C library object pointer (Arduino Wire Library).
         TwoWire *_touchI2CPtr = NULL;
 
+#if CYPRESS_TOUCH_KEEP_CHIP_INFO
         // Bootloader struct typedef.
         struct cyttspBootloaderData _blData;
 
         // System info data typedef.
         struct cyttspSysinfoData _sysData;
+#endif
+
+        // Touchscreen Controller init state.
+        volatile uint8_t _state = CYPRESS_TOUCH_STATE_OFF;
+
+        // Event group for waiting on the background init and callback called when it's done.
+        EventGroupHandle_t _initEvent = NULL;
+        void (*_readyCb)(bool _ok, void *_arg) = NULL;
+        void *_readyArg = NULL;
+
+        // I2C bus arbiter object pointer and client ID (optional).
+        CypressTouchBus *_busPtr = NULL;
+        int _busClient = -1;
+
+        // Index of the currently used I2C clock (last one is CYPRESS_TOUCH_I2C_CLOCK_SAFE).
+        uint8_t _i2cClockIndex = 0;
+
+        // I2C clock must not be changed (background init is running) and autotuning is left for
+        // the first call from the application task after the init.
+        volatile bool _i2cClockHold = false;
+
+        // Number of transfers and errors in the current error window.
+        uint16_t _i2cWindowTransfers = 0;
+        uint16_t _i2cWindowErrors = 0;
+
+        // Failed transfers are expected (bootloader NACKs while writing into the flash), they are
+        // not counted as errors.
+        bool _i2cExpectNack = false;
+
+        // I2C bus statistics.
+        struct cypressTouchI2CStats _i2cStats;
+
+        // Set I2C and I/O expander pins used by the Touchscreen Controller.
+        void initPins(TwoWire *_touchI2C, Inkplate *_display);
+
+        // Configure the Touchscreen Controller after the power up (slow part of the init).
+        bool bringUp();
+
+        // Background init task.
+        static void initTask(void *_arg);
 
         // Method disables or enables power to the Touchscreen.
         void power(bool _pwr);
 
+        // Set I/O expander pin state (with bus lock).
+        void writeIO(uint8_t _pin, uint8_t _state);
+
         // Methods executes HW reset (with Touchscreen RST pin).
         void reset();
 
@@ -114,6 +264,20 @@ class CypressTouch
         // Method forces Touchscreen Controller to exits bootloader mode and executes preloaded FW code.
         bool exitBootLoaderMode();
 
+#if CYPRESS_TOUCH_USE_FW_UPDATE
+        // Method forces Touchscreen Controller into bootloader mode (needed for firmware update).
+        bool enterBootLoaderMode();
+
+        // Send one firmware block to the bootloader.
+        bool writeFirmwareBlock(uint8_t *_packet, int _len);
+
+        // Fill bootloader block write packet.
+        int makeFirmwareBlockPacket(uint8_t *_packet, uint16_t _blockNum, const uint8_t *_data, int _len);
+
+        // Wait until bootloader is not busy anymore.
+        bool waitBootLoaderReady(struct cyttspBootloaderData *_blDataPtr, uint32_t _timeout);
+#endif
+
         // Force Touchscreen Controller into system info mode.
         bool setSysInfoMode(struct cyttspSysinfoData *_sysDataPtr);
 
@@ -126,14 +290,31 @@ class CypressTouch
         // Do a handshake for Touchscreen Controller to acknowledge successfull touch report read.
         void handshake();
 
-        // Needs to be removed.
-        void regDump(HardwareSerial *_debugSerialPtr, int _startAddress, int _endAddress);
-
+#if CYPRESS_TOUCH_USE_PRINT
         // Helper method for printing debug, info and error messages.
         void printMessage(HardwareSerial *_serial, char *_msgPrefix, char *_message);
+#endif
 
+#if CYPRESS_TOUCH_USE_TIMESTAMP
         // Helper method for printing timestamp with millis() Arduino function.
         void printTimestamp(HardwareSerial *_serial);
+#endif
+
+        // Find the fastest I2C clock that works with the Touchscreen Controller.
+        bool autotuneI2CClock();
+
+        // Do the I2C clock autotuning left out by the background init.
+        void finishAsyncInit();
+
+        // Set I2C clock from the list of the supported clocks.
+        void setI2CClock(uint8_t _index);
+
+        // Update I2C statistics after each transfer and switch to slower clock if needed.
+        bool i2cTransferDone(bool _ok, uint32_t _startTime);
+
+        // Lock and unlock the I2C bus (if bus arbiter is used).
+        void busLock();
+        void busUnlock();
 
         // Low-level I2C stuff.
         // Send command to the Touchscreen Controller via I2C.
@@ -32,8 +32,21 @@ void setup()
     display.begin();
 
     // Send Inkplate and Wire object pointers into the Cypress touch library.
-    // Init. the library,
-    if (!touch.begin(&Wire, &display))
+    // Start the init. of the library in the background (it needs the I/O expander, so display.begin() goes first).
+    if (!touch.beginAsync(&Wire, &display))
+    {
+        // Print error Message if touch init task can't be started.
+        // This will also halt the code.
+        touch.printError(&Serial, "Touch init start failed");
+    }
+
+    // Clear the screen while the touch is starting up (screen refresh takes the most of the boot time).
+    display.clearDisplay();
+    display.display();
+
+    // Wait for the touch init to finish (I2C clock is tuned here, init task doesn't change it while the
+    // display uses Wire).
+    if (!touch.waitReady(5000))
     {
         // Print error Message if touch init has failed.
         // This will also halt the code.
@@ -43,6 +56,11 @@ void setup()
     {
         // Print debug message.
         touch.printDebug(&Serial, "Touch init ok");
+
+        // Print selected I2C clock.
+        char _clockStr[40];
+        sprintf(_clockStr, "Touch I2C clock: %lu Hz", (unsigned long)touch.getI2CClock());
+        touch.printDebug(&Serial, _clockStr);
     }
 
     // Set low power mode (it periodically reads Touchscreen panel to reduce power.)
@@ -0,0 +1,297 @@
+// Include main header file of the awaitable touch API.
+#include "cypressTouchAwait.h"
+
+// Compile only if there is C++20 coroutine support.
+#if defined(__cpp_impl_coroutine)
+
+/**
+ * @brief Constructor for a new TouchAwaiter object. Use nextTouch(), nextPress(), nextRelease()
+ *        or nextEvent() instead of making it directly.
+ * 
+ */
+CypressTouchAwait::TouchAwaiter::TouchAwaiter(CypressTouchAwait *_owner, uint8_t _filter, uint32_t _timeout)
+{
+    _ownerPtr = _owner;
+    this->_filter = _filter;
+    this->_timeout = _timeout;
+    _start = 0;
+    _linked = false;
+    _next = NULL;
+    memset(&_result, 0, sizeof(_result));
+}
+
+/**
+ * @brief Destructor of the TouchAwaiter object. If the coroutine is destroyed while waiting (or
+ *        while it's waiting to be resumed), awaiter is removed from the list.
+ * 
+ */
+CypressTouchAwait::TouchAwaiter::~TouchAwaiter()
+{
+    if (_linked) _ownerPtr->remove(this);
+}
+
+/**
+ * @brief       Coroutine always waits for the next event.
+ * 
+ * @return      bool
+ *              false - Coroutine is always suspended.
+ */
+bool CypressTouchAwait::TouchAwaiter::await_ready()
+{
+    return false;
+}
+
+/**
+ * @brief       Suspend the coroutine and add the awaiter to the waiting list.
+ * 
+ * @param       std::coroutine_handle<> _handle
+ *              Handle of the suspended coroutine.
+ */
+void CypressTouchAwait::TouchAwaiter::await_suspend(std::coroutine_handle<> _handle)
+{
+    this->_handle = _handle;
+    _start = millis();
+    _ownerPtr->add(&_ownerPtr->_waiters, this);
+}
+
+/**
+ * @brief       Get the result when the coroutine is resumed.
+ * 
+ * @return      struct cypressTouchAwaitResult
+ *              valid - true if the event is received, false on timeout.
+ *              event - Defined in cypressTouchTypedefs.h, received touch event.
+ */
+struct cypressTouchAwaitResult CypressTouchAwait::TouchAwaiter::await_resume()
+{
+    return _result;
+}
+
+/**
+ * @brief Constructor for a new CypressTouchAwait object.
+ * 
+ */
+CypressTouchAwait::CypressTouchAwait()
+{
+
+}
+
+/**
+ * @brief       Initialize awaitable touch API. It subscribes to all touch events with its own queue.
+ * 
+ * @param       CypressTouchEvents *_events
+ *              Already initialized touch event dispatcher.
+ * 
+ * @return      bool
+ *              true - Initialization ok.
+ *              false - Null-pointer or there is no free subscriber slot.
+ */
+bool CypressTouchAwait::begin(CypressTouchEvents *_events)
+{
+    // Check for the null-pointer trap.
+    if (_events == NULL) return false;
+
+    _subscriber = _events->subscribe(CYPRESS_TOUCH_EVENT_ALL, CYPRESS_TOUCH_AWAIT_QUEUE_LEN);
+    if (_subscriber < 0) return false;
+
+    _eventsPtr = _events;
+
+    return true;
+}
+
+/**
+ * @brief       Wait for the next touch report of any type.
+ *              Usage: struct cypressTouchAwaitResult _res = co_await touchAwait.nextTouch(1000);
+ * 
+ * @param       uint32_t _timeout
+ *              Timeout in milliseconds (0 - wait forever).
+ * 
+ * @return      TouchAwaiter
+ *              Awaiter for the co_await.
+ */
+CypressTouchAwait::TouchAwaiter CypressTouchAwait::nextTouch(uint32_t _timeout)
+{
+    return TouchAwaiter(this, CYPRESS_TOUCH_EVENT_ALL, _timeout);
+}
+
+/**
+ * @brief       Wait for the next finger press.
+ * 
+ * @param       uint32_t _timeout
+ *              Timeout in milliseconds (0 - wait forever).
+ * 
+ * @return      TouchAwaiter
+ *              Awaiter for the co_await.
+ */
+CypressTouchAwait::TouchAwaiter CypressTouchAwait::nextPress(uint32_t _timeout)
+{
+    return TouchAwaiter(this, CYPRESS_TOUCH_EVENT_PRESS, _timeout);
+}
+
+/**
+ * @brief       Wait for the next finger release.
+ * 
+ * @param       uint32_t _timeout
+ *              Timeout in milliseconds (0 - wait forever).
+ * 
+ * @return      TouchAwaiter
+ *              Awaiter for the co_await.
+ */
+CypressTouchAwait::TouchAwaiter CypressTouchAwait::nextRelease(uint32_t _timeout)
+{
+    return TouchAwaiter(this, CYPRESS_TOUCH_EVENT_RELEASE, _timeout);
+}
+
+/**
+ * @brief       Wait for the next event that matches the filter.
+ * 
+ * @param       uint8_t _filter
+ *              Event types (CYPRESS_TOUCH_EVENT_PRESS, CYPRESS_TOUCH_EVENT_MOVE, CYPRESS_TOUCH_EVENT_RELEASE,
+ *              can be OR-ed together).
+ * @param       uint32_t _timeout
+ *              Timeout in milliseconds (0 - wait forever).
+ * 
+ * @return      TouchAwaiter
+ *              Awaiter for the co_await.
+ */
+CypressTouchAwait::TouchAwaiter CypressTouchAwait::nextEvent(uint8_t _filter, uint32_t _timeout)
+{
+    return TouchAwaiter(this, _filter, _timeout);
+}
+
+/**
+ * @brief       Resume waiting coroutines. It reads new touch report (if the interrupt has been
+ *              triggered), resumes coroutines waiting for that event type and resumes coroutines
+ *              whose timeout has expired. Coroutines are resumed from this method, so call it from
+ *              the scheduler loop of the task that runs them.
+ * 
+ * @return      int
+ *              Number of resumed coroutines.
+ */
+int CypressTouchAwait::poll()
+{
+    // Library must be initialized first.
+    if (_eventsPtr == NULL) return 0;
+
+    int _resumed = 0;
+
+    // Read new touch report (if there is one). It's sent to other subscribers too.
+    _eventsPtr->dispatch();
+
+    // Resume coroutines waiting for the received events.
+    struct cypressTouchEvent _event;
+    while (_eventsPtr->receive(_subscriber, &_event, 0))
+    {
+        _resumed += resumeMatching(&_event, 0);
+    }
+
+    // Resume coroutines with expired timeout.
+    _resumed += resumeMatching(NULL, millis());
+
+    return _resumed;
+}
+
+/**
+ * @brief       Add awaiter to the end of the list.
+ * 
+ * @param       TouchAwaiter **_list
+ *              Waiting or ready list.
+ * @param       TouchAwaiter *_awaiter
+ *              Awaiter of the suspended coroutine.
+ */
+void CypressTouchAwait::add(TouchAwaiter **_list, TouchAwaiter *_awaiter)
+{
+    TouchAwaiter **_tail = _list;
+    while (*_tail != NULL) _tail = &(*_tail)->_next;
+
+    _awaiter->_next = NULL;
+    _awaiter->_linked = true;
+    *_tail = _awaiter;
+}
+
+/**
+ * @brief       Remove awaiter from the waiting or ready list.
+ * 
+ * @param       TouchAwaiter *_awaiter
+ *              Awaiter that needs to be removed.
+ */
+void CypressTouchAwait::remove(TouchAwaiter *_awaiter)
+{
+    TouchAwaiter **_lists[] = {&_waiters, &_ready};
+
+    for (int i = 0; i < 2; i++)
+    {
+        for (TouchAwaiter **_pp = _lists[i]; *_pp != NULL; _pp = &(*_pp)->_next)
+        {
+            if (*_pp == _awaiter)
+            {
+                *_pp = _awaiter->_next;
+                _awaiter->_next = NULL;
+                _awaiter->_linked = false;
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * @brief       Resume all awaiters that match the event (or whose timeout has expired if there is no
+ *              event). Matching awaiters are moved to the ready list first, so resumed coroutine can
+ *              co_await again right away. Coroutine resumed first can destroy other coroutine from the
+ *              same batch, its awaiter then removes itself from the ready list and it's not resumed.
+ * 
+ * @param       const struct cypressTouchEvent *_event
+ *              Received event or NULL for the timeout check.
+ * @param       uint32_t _now
+ *              Current time in milliseconds (used only for the timeout check).
+ * 
+ * @return      int
+ *              Number of resumed coroutines.
+ */
+int CypressTouchAwait::resumeMatching(const struct cypressTouchEvent *_event, uint32_t _now)
+{
+    TouchAwaiter **_pp = &_waiters;
+    while (*_pp != NULL)
+    {
+        TouchAwaiter *_awaiter = *_pp;
+
+        bool _match;
+        if (_event != NULL)
+        {
+            _match = (_awaiter->_filter & _event->type) ? true : false;
+        }
+        else
+        {
+            _match = (_awaiter->_timeout != 0 && (uint32_t)(_now - _awaiter->_start) >= _awaiter->_timeout) ? true : false;
+        }
+
+        if (!_match)
+        {
+            _pp = &_awaiter->_next;
+            continue;
+        }
+
+        // Move it to the ready list and set the result.
+        *_pp = _awaiter->_next;
+        add(&_ready, _awaiter);
+
+        _awaiter->_result.valid = _event != NULL ? true : false;
+        if (_event != NULL) _awaiter->_result.event = *_event;
+    }
+
+    // Resume them one by one. Each resume can destroy other awaiters in the ready list, so always
+    // take the first one that is still there.
+    int _resumed = 0;
+    while (_ready != NULL)
+    {
+        TouchAwaiter *_awaiter = _ready;
+        _ready = _awaiter->_next;
+        _awaiter->_next = NULL;
+        _awaiter->_linked = false;
+        _awaiter->_handle.resume();
+        _resumed++;
+    }
+
+    return _resumed;
+}
+
+#endif
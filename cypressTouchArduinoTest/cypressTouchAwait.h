@@ -0,0 +1,99 @@
+#ifndef __CYPRESSTOUCHAWAIT_H__
+#define __CYPRESSTOUCHAWAIT_H__
+
+// Awaitable touch API needs C++20 coroutines (-std=gnu++20, GCC 10 also needs -fcoroutines).
+#if defined(__cpp_impl_coroutine)
+
+// Include C++20 coroutine support.
+#include <coroutine>
+
+// Include main Arduino header file.
+#include <Arduino.h>
+
+// Include touch event dispatcher (awaiters get the events from it).
+#include "cypressTouchEvents.h"
+
+// Size of the event queue between the dispatcher and the awaiters.
+#define CYPRESS_TOUCH_AWAIT_QUEUE_LEN   8
+
+// Result of the awaited touch (valid is false on timeout).
+struct cypressTouchAwaitResult
+{
+    bool valid;
+    struct cypressTouchEvent event;
+};
+
+class CypressTouchAwait
+{
+    public:
+        // Awaiter returned by nextTouch(), nextPress(), nextRelease() and nextEvent().
+        // It lives in the coroutine frame, so there is no heap allocation per await.
+        class TouchAwaiter
+        {
+            public:
+                TouchAwaiter(CypressTouchAwait *_owner, uint8_t _filter, uint32_t _timeout);
+                ~TouchAwaiter();
+
+                // Coroutine awaiter interface.
+                bool await_ready();
+                void await_suspend(std::coroutine_handle<> _handle);
+                struct cypressTouchAwaitResult await_resume();
+
+            private:
+                friend class CypressTouchAwait;
+
+                CypressTouchAwait *_ownerPtr;
+                uint8_t _filter;
+                uint32_t _timeout;
+                uint32_t _start;
+                bool _linked;
+                std::coroutine_handle<> _handle;
+                struct cypressTouchAwaitResult _result;
+                TouchAwaiter *_next;
+        };
+
+        // Library constructor.
+        CypressTouchAwait();
+
+        // Initialization function.
+        bool begin(CypressTouchEvents *_events);
+
+        // Wait for the next touch report of any type.
+        TouchAwaiter nextTouch(uint32_t _timeout = 0);
+
+        // Wait for the next finger press.
+        TouchAwaiter nextPress(uint32_t _timeout = 0);
+
+        // Wait for the next finger release.
+        TouchAwaiter nextRelease(uint32_t _timeout = 0);
+
+        // Wait for the next event that matches the filter.
+        TouchAwaiter nextEvent(uint8_t _filter, uint32_t _timeout = 0);
+
+        // Resume waiting coroutines (call it from the scheduler loop).
+        int poll();
+
+    private:
+        // Touch event dispatcher and subscriber ID.
+        CypressTouchEvents *_eventsPtr = NULL;
+        int _subscriber = -1;
+
+        // List of the waiting awaiters.
+        TouchAwaiter *_waiters = NULL;
+
+        // List of the awaiters that are going to be resumed (they can still be destroyed before the resume).
+        TouchAwaiter *_ready = NULL;
+
+        // Add awaiter to the list.
+        void add(TouchAwaiter **_list, TouchAwaiter *_awaiter);
+
+        // Remove awaiter from the waiting or ready list.
+        void remove(TouchAwaiter *_awaiter);
+
+        // Resume all awaiters that match the condition.
+        int resumeMatching(const struct cypressTouchEvent *_event, uint32_t _now);
+};
+
+#endif
+
+#endif
@@ -0,0 +1,423 @@
+// Include main header file of the I2C bus arbiter.
+#include "cypressTouchBus.h"
+
+/**
+ * @brief Constructor for a new CypressTouchBus object.
+ * 
+ */
+CypressTouchBus::CypressTouchBus()
+{
+    memset(_clients, 0, sizeof(_clients));
+}
+
+/**
+ * @brief       Initialize I2C bus arbiter.
+ * 
+ * @param       TwoWire *_wire
+ *              Arduino TwoWire object (I2C library) shared by all bus clients.
+ * 
+ * @return      bool
+ *              true - Initialization ok.
+ *              false - Null-pointer.
+ */
+bool CypressTouchBus::begin(TwoWire *_wire)
+{
+    // Check for the null-pointer trap.
+    if (_wire == NULL) return false;
+
+    // Copy library object into the internal one.
+    _wirePtr = _wire;
+
+    // Start the statistics.
+    clearStats();
+
+    return true;
+}
+
+/**
+ * @brief       Get the Wire object used by the bus.
+ * 
+ * @return      TwoWire*
+ *              Arduino TwoWire object.
+ */
+TwoWire *CypressTouchBus::getWire()
+{
+    return _wirePtr;
+}
+
+/**
+ * @brief       Register new bus client. Each task that uses the bus should have its own client.
+ * 
+ * @param       const char *_name
+ *              Client name (for the debug, string is not copied).
+ * @param       uint8_t _priority
+ *              Client priority (CYPRESS_TOUCH_BUS_PRIO_LOW, CYPRESS_TOUCH_BUS_PRIO_NORMAL,
+ *              CYPRESS_TOUCH_BUS_PRIO_TOUCH or any other number, higher is more important).
+ * 
+ * @return      int
+ *              Client ID or -1 if there is no free client slot.
+ */
+int CypressTouchBus::addClient(const char *_name, uint8_t _priority)
+{
+    for (int i = 0; i < CYPRESS_TOUCH_BUS_MAX_CLIENTS; i++)
+    {
+        if (!_clients[i].used)
+        {
+            memset(&_clients[i], 0, sizeof(struct cypressTouchBusClient));
+            _clients[i].name = _name;
+            _clients[i].priority = _priority;
+            _clients[i].used = true;
+
+            return i;
+        }
+    }
+
+    // No free slot.
+    return -1;
+}
+
+/**
+ * @brief       Get exclusive access to the bus. If the bus is busy, task waits until the bus is
+ *              released. Waiting client with the highest priority gets the bus first (clients with the
+ *              same priority get it in order of the request).
+ * 
+ * @param       int _client
+ *              Client ID returned by addClient().
+ * @param       uint32_t _timeout
+ *              Max. time to wait for the bus in milliseconds (portMAX_DELAY to wait forever).
+ * 
+ * @return      bool
+ *              true - Bus is locked by this client, unlock() must be called after the transaction.
+ *              false - Timeout or wrong client ID.
+ * 
+ * @note        Task that already owns the bus can lock it again with the same client, unlock() must
+ *              be called the same number of times. Other task that uses the same client ID waits
+ *              like any other client.
+ */
+bool CypressTouchBus::lock(int _client, uint32_t _timeout)
+{
+    // Check the parameters.
+    if (!validClient(_client)) return false;
+
+    struct cypressTouchBusClient *_cl = &_clients[_client];
+    TaskHandle_t _task = xTaskGetCurrentTaskHandle();
+    uint32_t _waitStart = micros();
+
+    portENTER_CRITICAL(&_mux);
+
+    // Already owns the bus (same client from the same task)?
+    if (_busy && _owner == _client && _ownerTask == _task)
+    {
+        _depth++;
+        portEXIT_CRITICAL(&_mux);
+        return true;
+    }
+
+    if (!_busy)
+    {
+        // Bus is free, take it.
+        _busy = true;
+        _owner = _client;
+        _ownerTask = _task;
+        _depth = 1;
+        portEXIT_CRITICAL(&_mux);
+    }
+    else
+    {
+        // Bus is busy, add the task to the end of the waiting list.
+        struct cypressTouchBusWaiter _waiter = {_client, _task, false, NULL};
+        struct cypressTouchBusWaiter **_last = &_waiters;
+        while (*_last != NULL) _last = &(*_last)->next;
+        *_last = &_waiter;
+        portEXIT_CRITICAL(&_mux);
+
+        TickType_t _ticks = _timeout == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(_timeout);
+        if (ulTaskNotifyTake(pdTRUE, _ticks) == 0)
+        {
+            portENTER_CRITICAL(&_mux);
+            if (!_waiter.granted)
+            {
+                // Still waiting - timeout, remove the task from the waiting list.
+                struct cypressTouchBusWaiter **_w = &_waiters;
+                while (*_w != &_waiter) _w = &(*_w)->next;
+                *_w = _waiter.next;
+                portEXIT_CRITICAL(&_mux);
+                return false;
+            }
+            portEXIT_CRITICAL(&_mux);
+
+            // Bus has been given just after the timeout. Owner has set granted flag, so the notification
+            // follows right after it leaves the critical section. Wait for it, so it's not left pending.
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+    }
+
+    // Update the statistics.
+    _cl->lockStart = micros();
+    uint32_t _waitTime = _cl->lockStart - _waitStart;
+    _cl->stats.transactions++;
+    _cl->stats.waitTime += _waitTime;
+    if (_waitTime > _cl->stats.maxWaitTime) _cl->stats.maxWaitTime = _waitTime;
+
+    return true;
+}
+
+/**
+ * @brief       Release the bus. If there are tasks waiting for the bus, it's given to the one
+ *              with the highest client priority.
+ * 
+ * @param       int _client
+ *              Client ID returned by addClient().
+ */
+void CypressTouchBus::unlock(int _client)
+{
+    // Check the parameters.
+    if (!validClient(_client)) return;
+
+    struct cypressTouchBusClient *_cl = &_clients[_client];
+    struct cypressTouchBusWaiter *_next = NULL;
+    TaskHandle_t _nextTask = NULL;
+
+    portENTER_CRITICAL(&_mux);
+
+    // Only the owner can release the bus and only after the last unlock.
+    if (!_busy || _owner != _client || _ownerTask != xTaskGetCurrentTaskHandle() || --_depth > 0)
+    {
+        portEXIT_CRITICAL(&_mux);
+        return;
+    }
+
+    // Update the busy time.
+    uint32_t _time = micros() - _cl->lockStart;
+    _cl->stats.busyTime += _time;
+    _busyTime += _time;
+
+    // Find waiting task with the highest priority (the first one in the list if the priority is the same).
+    struct cypressTouchBusWaiter **_nextLink = NULL;
+    for (struct cypressTouchBusWaiter **_w = &_waiters; *_w != NULL; _w = &(*_w)->next)
+    {
+        if (_next == NULL || _clients[(*_w)->client].priority > _clients[_next->client].priority)
+        {
+            _next = *_w;
+            _nextLink = _w;
+        }
+    }
+
+    if (_next != NULL)
+    {
+        // Hand over the bus and remove the task from the waiting list.
+        *_nextLink = _next->next;
+        _next->granted = true;
+        _nextTask = _next->task;
+        _owner = _next->client;
+        _ownerTask = _next->task;
+        _depth = 1;
+    }
+    else
+    {
+        // Nobody is waiting, bus is free.
+        _busy = false;
+        _owner = -1;
+        _ownerTask = NULL;
+        _depth = 0;
+    }
+
+    portEXIT_CRITICAL(&_mux);
+
+    // Wake up the new owner (waiter is on its stack, so only the task handle is used here).
+    if (_nextTask != NULL) xTaskNotifyGive(_nextTask);
+}
+
+/**
+ * @brief       Queue register write. If the write goes to the same device and to the register right
+ *              after the previous queued write, they are merged into one I2C transaction. Otherwise
+ *              previous queued data is sent first.
+ * 
+ * @param       int _client
+ *              Client ID returned by addClient().
+ * @param       uint8_t _addr
+ *              I2C address of the device (7 bit).
+ * @param       uint8_t _reg
+ *              First register address.
+ * @param       const uint8_t *_data
+ *              Register data.
+ * @param       int _len
+ *              Number of registers.
+ * 
+ * @return      bool
+ *              true - Write is queued (or sent).
+ *              false - Sending previous data has failed or wrong parameters.
+ * 
+ * @note        Call flush() to send the queued data. It's meant for the clients that write a lot of
+ *              registers one by one (like IO expander). Touch driver doesn't use it, its writes don't go
+ *              to the consecutive registers (commands to register 0x00, sysinfo writes to 0x1D).
+ */
+bool CypressTouchBus::queueWrite(int _client, uint8_t _addr, uint8_t _reg, const uint8_t *_data, int _len)
+{
+    // Check the parameters.
+    if (!validClient(_client) || _data == NULL || _len <= 0) return false;
+
+    struct cypressTouchBusClient *_cl = &_clients[_client];
+
+    // Write buffer of the client is used only while the bus is locked (other task can use the same client).
+    if (!lock(_client)) return false;
+
+    // Can it be merged with the queued write?
+    if (_cl->writeLen && _cl->writeAddr == _addr && (uint8_t)(_cl->writeReg + _cl->writeLen) == _reg && (_cl->writeLen + _len) <= CYPRESS_TOUCH_BUS_WRITE_BUFFER)
+    {
+        memcpy(_cl->writeData + _cl->writeLen, _data, _len);
+        _cl->writeLen += _len;
+        _cl->stats.mergedWrites++;
+        unlock(_client);
+        return true;
+    }
+
+    // Send the queued data first.
+    bool _ret = flush(_client);
+
+    if (_ret && _len > CYPRESS_TOUCH_BUS_WRITE_BUFFER)
+    {
+        // Too big to be queued, send it right away.
+        _ret = writeRegs(_addr, _reg, _data, _len);
+    }
+    else if (_ret)
+    {
+        // Queue it.
+        _cl->writeAddr = _addr;
+        _cl->writeReg = _reg;
+        _cl->writeLen = _len;
+        memcpy(_cl->writeData, _data, _len);
+    }
+
+    unlock(_client);
+
+    return _ret;
+}
+
+/**
+ * @brief       Send queued register writes of the client.
+ * 
+ * @param       int _client
+ *              Client ID returned by addClient().
+ * 
+ * @return      bool
+ *              true - Data is sent (or there was nothing to send).
+ *              false - I2C write failed or wrong client ID.
+ */
+bool CypressTouchBus::flush(int _client)
+{
+    // Check the parameters.
+    if (!validClient(_client)) return false;
+
+    struct cypressTouchBusClient *_cl = &_clients[_client];
+
+    if (!lock(_client)) return false;
+
+    // Anything to send?
+    bool _ret = true;
+    if (_cl->writeLen) _ret = writeRegs(_cl->writeAddr, _cl->writeReg, _cl->writeData, _cl->writeLen);
+    _cl->writeLen = 0;
+
+    unlock(_client);
+
+    return _ret;
+}
+
+/**
+ * @brief       Get statistics of the client - number of transactions, merged writes, time the client
+ *              used the bus and time it waited for the bus (queueing delay).
+ * 
+ * @param       int _client
+ *              Client ID returned by addClient().
+ * @param       struct cypressTouchBusStats *_stats
+ *              Defined in cypressTouchTypedefs.h, statistics will be copied here.
+ * 
+ * @return      bool
+ *              true - Statistics copied.
+ *              false - Wrong parameters.
+ */
+bool CypressTouchBus::getClientStats(int _client, struct cypressTouchBusStats *_stats)
+{
+    // Check the parameters.
+    if (!validClient(_client) || _stats == NULL) return false;
+
+    portENTER_CRITICAL(&_mux);
+    memcpy(_stats, &_clients[_client].stats, sizeof(struct cypressTouchBusStats));
+    portEXIT_CRITICAL(&_mux);
+
+    return true;
+}
+
+/**
+ * @brief       Get bus occupancy - how much of the time bus was locked by any client since the last
+ *              clearStats().
+ * 
+ * @return      uint8_t
+ *              Bus occupancy in percent.
+ */
+uint8_t CypressTouchBus::getOccupancy()
+{
+    uint64_t _elapsed = (uint64_t)(millis() - _statsStart) * 1000ULL;
+    if (_elapsed == 0) return 0;
+
+    uint64_t _percent = (_busyTime * 100ULL) / _elapsed;
+    return _percent > 100 ? 100 : _percent;
+}
+
+/**
+ * @brief       Clear statistics of all clients and the bus occupancy.
+ * 
+ */
+void CypressTouchBus::clearStats()
+{
+    portENTER_CRITICAL(&_mux);
+    for (int i = 0; i < CYPRESS_TOUCH_BUS_MAX_CLIENTS; i++)
+    {
+        memset(&_clients[i].stats, 0, sizeof(struct cypressTouchBusStats));
+    }
+    _busyTime = 0;
+    _statsStart = millis();
+    portEXIT_CRITICAL(&_mux);
+}
+
+/**
+ * @brief       Check client ID.
+ * 
+ * @param       int _client
+ *              Client ID returned by addClient().
+ * 
+ * @return      bool
+ *              true - Client exists.
+ *              false - Wrong client ID.
+ */
+bool CypressTouchBus::validClient(int _client)
+{
+    return (_client >= 0 && _client < CYPRESS_TOUCH_BUS_MAX_CLIENTS && _clients[_client].used) ? true : false;
+}
+
+/**
+ * @brief       Write data to the I2C device registers. Bus must be locked.
+ * 
+ * @param       uint8_t _addr
+ *              I2C address of the device (7 bit).
+ * @param       uint8_t _reg
+ *              First register address.
+ * @param       const uint8_t *_data
+ *              Register data.
+ * @param       int _len
+ *              Number of registers.
+ * 
+ * @return      bool
+ *              true - I2C write was successfull.
+ *              false - I2C write failed.
+ */
+bool CypressTouchBus::writeRegs(uint8_t _addr, uint8_t _reg, const uint8_t *_data, int _len)
+{
+    // Check for the null-pointer trap.
+    if (_wirePtr == NULL) return false;
+
+    _wirePtr->beginTransmission(_addr);
+    _wirePtr->write(_reg);
+    _wirePtr->write(_data, _len);
+    return _wirePtr->endTransmission() == 0 ? true : false;
+}
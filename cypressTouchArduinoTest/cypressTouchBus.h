@@ -0,0 +1,117 @@
+#ifndef __CYPRESSTOUCHBUS_H__
+#define __CYPRESSTOUCHBUS_H__
+
+// Include main Arduino header file.
+#include <Arduino.h>
+
+// Include Wire library (I2C Arduino Library).
+#include <Wire.h>
+
+// Include FreeRTOS tasks (bus owner is the task, waiting task is woken by the task notification).
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Include Cypress touchscreen typedefs.
+#include "cypressTouchTypedefs.h"
+
+// Max. number of the bus clients.
+#define CYPRESS_TOUCH_BUS_MAX_CLIENTS   6
+
+// Bus client priorities (higher number - higher priority).
+#define CYPRESS_TOUCH_BUS_PRIO_LOW      0
+#define CYPRESS_TOUCH_BUS_PRIO_NORMAL   1
+#define CYPRESS_TOUCH_BUS_PRIO_TOUCH    3
+
+// Size of the buffer for merging register writes of one client.
+#define CYPRESS_TOUCH_BUS_WRITE_BUFFER  32
+
+class CypressTouchBus
+{
+    public:
+        // Library constructor.
+        CypressTouchBus();
+
+        // Initialization function.
+        bool begin(TwoWire *_wire);
+
+        // Get the Wire object used by the bus.
+        TwoWire *getWire();
+
+        // Register new bus client.
+        int addClient(const char *_name, uint8_t _priority);
+
+        // Get exclusive access to the bus.
+        bool lock(int _client, uint32_t _timeout = portMAX_DELAY);
+
+        // Release the bus (it's given to the waiting client with the highest priority).
+        void unlock(int _client);
+
+        // Queue register write (merged with the previous one if registers follow each other).
+        bool queueWrite(int _client, uint8_t _addr, uint8_t _reg, const uint8_t *_data, int _len);
+
+        // Send queued register writes.
+        bool flush(int _client);
+
+        // Get statistics of the client.
+        bool getClientStats(int _client, struct cypressTouchBusStats *_stats);
+
+        // Get bus occupancy (in percent) since the last clearStats().
+        uint8_t getOccupancy();
+
+        // Clear all statistics.
+        void clearStats();
+
+    private:
+        // Bus client data.
+        struct cypressTouchBusClient
+        {
+            bool used;
+            const char *name;
+            uint8_t priority;
+            uint32_t lockStart;
+            uint8_t writeAddr;
+            uint8_t writeReg;
+            uint8_t writeLen;
+            uint8_t writeData[CYPRESS_TOUCH_BUS_WRITE_BUFFER];
+            struct cypressTouchBusStats stats;
+        };
+
+        // Task waiting for the bus (lives on the stack of the waiting task).
+        struct cypressTouchBusWaiter
+        {
+            int client;
+            TaskHandle_t task;
+            bool granted;
+            struct cypressTouchBusWaiter *next;
+        };
+
+        // I2C library object pointer (Arduino Wire Library).
+        TwoWire *_wirePtr = NULL;
+
+        // Bus clients.
+        struct cypressTouchBusClient _clients[CYPRESS_TOUCH_BUS_MAX_CLIENTS];
+
+        // Spinlock for the bus state.
+        portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+        // Bus state. Owner (client and task) can lock the bus multiple times (depth).
+        bool _busy = false;
+        int _owner = -1;
+        TaskHandle_t _ownerTask = NULL;
+        int _depth = 0;
+
+        // Tasks waiting for the bus, in order of the request.
+        struct cypressTouchBusWaiter *_waiters = NULL;
+
+        // Bus busy time and the time when statistics were cleared.
+        uint64_t _busyTime = 0;
+        unsigned long _statsStart = 0;
+
+        // Check client ID.
+        bool validClient(int _client);
+
+        // Write data to the I2C device register.
+        bool writeRegs(uint8_t _addr, uint8_t _reg, const uint8_t *_data, int _len);
+};
+
+#endif
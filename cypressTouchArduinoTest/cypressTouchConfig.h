@@ -0,0 +1,56 @@
+#ifndef __CYPRESSTOUCHCONFIG_H__
+#define __CYPRESSTOUCHCONFIG_H__
+
+// Build profiles of the Cypress touch library.
+// Minimal - only touch init and touch reports.
+// Standard - minimal + serial print helpers and firmware update (default).
+// Diagnostic - standard + timestamps in the print helpers, register dump and bootloader/system info
+// kept in RAM after the init.
+#define CYPRESS_TOUCH_PROFILE_MINIMAL       0
+#define CYPRESS_TOUCH_PROFILE_STANDARD      1
+#define CYPRESS_TOUCH_PROFILE_DIAGNOSTIC    2
+
+// Selected build profile. Can be set from the build flags (-DCYPRESS_TOUCH_PROFILE=0).
+#ifndef CYPRESS_TOUCH_PROFILE
+#define CYPRESS_TOUCH_PROFILE               CYPRESS_TOUCH_PROFILE_STANDARD
+#endif
+
+// Each feature can also be enabled or disabled from the build flags, regardless of the profile.
+// Serial print helpers (printInfo(), printDebug(), printError()).
+#ifndef CYPRESS_TOUCH_USE_PRINT
+#define CYPRESS_TOUCH_USE_PRINT             (CYPRESS_TOUCH_PROFILE >= CYPRESS_TOUCH_PROFILE_STANDARD)
+#endif
+
+// Firmware update through the bootloader (updateFirmware()).
+#ifndef CYPRESS_TOUCH_USE_FW_UPDATE
+#define CYPRESS_TOUCH_USE_FW_UPDATE         (CYPRESS_TOUCH_PROFILE >= CYPRESS_TOUCH_PROFILE_STANDARD)
+#endif
+
+// Timestamp in the print messages (uses printf).
+#ifndef CYPRESS_TOUCH_USE_TIMESTAMP
+#define CYPRESS_TOUCH_USE_TIMESTAMP         (CYPRESS_TOUCH_PROFILE >= CYPRESS_TOUCH_PROFILE_DIAGNOSTIC)
+#endif
+
+// Touchscreen Controller register dump on the serial (regDump()).
+#ifndef CYPRESS_TOUCH_USE_REG_DUMP
+#define CYPRESS_TOUCH_USE_REG_DUMP          (CYPRESS_TOUCH_PROFILE >= CYPRESS_TOUCH_PROFILE_DIAGNOSTIC)
+#endif
+
+// Keep bootloader and system info registers in RAM after the init (getBootloaderData(), getSysInfoData()).
+#ifndef CYPRESS_TOUCH_KEEP_CHIP_INFO
+#define CYPRESS_TOUCH_KEEP_CHIP_INFO        (CYPRESS_TOUCH_PROFILE >= CYPRESS_TOUCH_PROFILE_DIAGNOSTIC)
+#endif
+
+// I2C clocks above 400 kHz (800 kHz and 1 MHz) in the clock autotuning. Wire is shared with the I/O
+// expanders and other devices on the board and setClock() changes the clock of the whole bus, so
+// enable it only if every device on the bus works at these clocks.
+#ifndef CYPRESS_TOUCH_I2C_FAST_PLUS
+#define CYPRESS_TOUCH_I2C_FAST_PLUS         0
+#endif
+
+// Register dump prints the registers, so it needs print helpers.
+#if CYPRESS_TOUCH_USE_REG_DUMP && !CYPRESS_TOUCH_USE_PRINT
+#error "CYPRESS_TOUCH_USE_REG_DUMP needs CYPRESS_TOUCH_USE_PRINT"
+#endif
+
+#endif
@@ -0,0 +1,485 @@
+// Include main header file of the edge non-linearity correction.
+#include "cypressTouchCorrection.h"
+
+// Layout of the mesh stored into flash.
+struct cypressTouchMeshStorage
+{
+    uint16_t magic;
+    uint8_t cols;
+    uint8_t rows;
+    int16_t dx[CYPRESS_TOUCH_MESH_MAX_ROWS][CYPRESS_TOUCH_MESH_MAX_COLS];
+    int16_t dy[CYPRESS_TOUCH_MESH_MAX_ROWS][CYPRESS_TOUCH_MESH_MAX_COLS];
+};
+
+/**
+ * @brief Constructor for a new CypressTouchCorrection object.
+ * 
+ */
+CypressTouchCorrection::CypressTouchCorrection()
+{
+    memset(_dx, 0, sizeof(_dx));
+    memset(_dy, 0, sizeof(_dy));
+    memset(_cellX, 0, sizeof(_cellX));
+    memset(_cellY, 0, sizeof(_cellY));
+}
+
+/**
+ * @brief       Set the number of the mesh nodes. Nodes are evenly spaced over the whole touchscreen
+ *              (0 - CYPRESS_TOUCH_MAX_X and 0 - CYPRESS_TOUCH_MAX_Y). All offsets are cleared.
+ * 
+ * @param       uint8_t _cols
+ *              Number of the nodes in X direction (2 - CYPRESS_TOUCH_MESH_MAX_COLS).
+ * @param       uint8_t _rows
+ *              Number of the nodes in Y direction (2 - CYPRESS_TOUCH_MESH_MAX_ROWS).
+ * 
+ * @return      bool
+ *              true - Mesh size is set.
+ *              false - Wrong mesh size.
+ */
+bool CypressTouchCorrection::setGrid(uint8_t _cols, uint8_t _rows)
+{
+    // Check the parameters.
+    if (_cols < 2 || _rows < 2 || _cols > CYPRESS_TOUCH_MESH_MAX_COLS || _rows > CYPRESS_TOUCH_MESH_MAX_ROWS) return false;
+
+    this->_cols = _cols;
+    this->_rows = _rows;
+
+    // Raw position to cell position scale.
+    _scaleX = ((uint32_t)(_cols - 1) << 16) / CYPRESS_TOUCH_MAX_X;
+    _scaleY = ((uint32_t)(_rows - 1) << 16) / CYPRESS_TOUCH_MAX_Y;
+
+    // Clear the offsets.
+    memset(_dx, 0, sizeof(_dx));
+    memset(_dy, 0, sizeof(_dy));
+    buildTable();
+
+    return true;
+}
+
+/**
+ * @brief       Set measured offset of one mesh node (correct position - reported position).
+ * 
+ * @param       uint8_t _col
+ *              Node column.
+ * @param       uint8_t _row
+ *              Node row.
+ * @param       int16_t _dx
+ *              X offset in touch controller units.
+ * @param       int16_t _dy
+ *              Y offset in touch controller units.
+ * 
+ * @return      bool
+ *              true - Offset is set.
+ *              false - Wrong node.
+ * 
+ * @note        Cell coefficients are calculated again, so it's not meant to be called for each report.
+ */
+bool CypressTouchCorrection::setOffset(uint8_t _col, uint8_t _row, int16_t _dx, int16_t _dy)
+{
+    // Check the parameters.
+    if (_col >= _cols || _row >= _rows) return false;
+
+    this->_dx[_row][_col] = _dx;
+    this->_dy[_row][_col] = _dy;
+    buildTable();
+
+    return true;
+}
+
+/**
+ * @brief       Get raw touch position of the mesh node.
+ * 
+ * @param       uint8_t _col
+ *              Node column.
+ * @param       uint8_t _row
+ *              Node row.
+ * @param       uint16_t *_x
+ *              X position will be stored here.
+ * @param       uint16_t *_y
+ *              Y position will be stored here.
+ */
+void CypressTouchCorrection::getNodePosition(uint8_t _col, uint8_t _row, uint16_t *_x, uint16_t *_y)
+{
+    *_x = _cols > 1 ? ((uint32_t)_col * CYPRESS_TOUCH_MAX_X) / (_cols - 1) : 0;
+    *_y = _rows > 1 ? ((uint32_t)_row * CYPRESS_TOUCH_MAX_Y) / (_rows - 1) : 0;
+}
+
+/**
+ * @brief       Correct all contacts in the touch report. Call it on the raw report (before scale()).
+ * 
+ * @param       struct cypressTouchData *_touchData
+ *              Defined in cypressTouchTypedefs.h, touch report.
+ */
+void CypressTouchCorrection::apply(struct cypressTouchData *_touchData)
+{
+    // Check for the null-pointer trap.
+    if (_touchData == NULL) return;
+
+    for (int i = 0; i < _touchData->fingers && i < 2; i++)
+    {
+        applyPoint(&_touchData->x[i], &_touchData->y[i]);
+    }
+}
+
+/**
+ * @brief       Correct one point. Offset is bilinearly interpolated between four mesh nodes
+ *              around the point by using precomputed cell coefficients (two multiplies for the
+ *              position inside the mesh and four for each axis).
+ * 
+ * @param       uint16_t *_x
+ *              Raw X position, corrected position will be stored here.
+ * @param       uint16_t *_y
+ *              Raw Y position, corrected position will be stored here.
+ */
+void CypressTouchCorrection::applyPoint(uint16_t *_x, uint16_t *_y)
+{
+    // Mesh not set?
+    if (_cols < 2 || _rows < 2) return;
+
+    // Get the offsets.
+    int32_t _dx, _dy;
+    interpolate(*_x, *_y, &_dx, &_dy);
+
+    // Apply them and keep the point inside the touchscreen.
+    *_x = constrain((int32_t)*_x + _dx, (int32_t)0, (int32_t)CYPRESS_TOUCH_MAX_X);
+    *_y = constrain((int32_t)*_y + _dy, (int32_t)0, (int32_t)CYPRESS_TOUCH_MAX_Y);
+}
+
+/**
+ * @brief       Guided on-screen calibration. Crosshair is shown on each mesh node, user must touch
+ *              its center and release the finger. Error of each node is the difference between
+ *              the average reported position and the node position. Errors are then converted
+ *              into correction offsets for the reported positions (see invertMesh()).
+ * 
+ * @param       CypressTouch *_touch
+ *              Already initialized Cypress touch library object.
+ * @param       Inkplate *_display
+ *              Inkplate library object for drawing the targets.
+ * @param       uint16_t _xSize
+ *              Screen size in pixels for X axis.
+ * @param       uint16_t _ySize
+ *              Screen size in pixels for Y axis.
+ * @param       bool _flipX
+ *              Flip the direction of the X axis.
+ * @param       bool _flipY
+ *              Flip the direction of the Y axis.
+ * @param       bool _swapXY
+ *              Swap X and Y cooridinates.
+ * 
+ * @return      bool
+ *              true - Calibration done, call save() to store the mesh.
+ *              false - Mesh size not set, null-pointer or there was no touch on the target (timeout).
+ */
+bool CypressTouchCorrection::calibrate(CypressTouch *_touch, Inkplate *_display, uint16_t _xSize, uint16_t _ySize, bool _flipX, bool _flipY, bool _swapXY)
+{
+    // Check for the null-pointer trap and mesh size.
+    if (_touch == NULL || _display == NULL || _cols < 2 || _rows < 2) return false;
+
+    // Start with the clear mesh.
+    memset(_dx, 0, sizeof(_dx));
+    memset(_dy, 0, sizeof(_dy));
+
+    // Clear the screen.
+    _display->clearDisplay();
+    _display->display();
+
+    for (int _row = 0; _row < _rows; _row++)
+    {
+        for (int _col = 0; _col < _cols; _col++)
+        {
+            // Get the node position on the touchscreen and on the screen.
+            uint16_t _nodeX, _nodeY;
+            int _screenX, _screenY;
+            getNodePosition(_col, _row, &_nodeX, &_nodeY);
+            rawToScreen(_nodeX, _nodeY, _xSize, _ySize, _flipX, _flipY, _swapXY, &_screenX, &_screenY);
+
+            // Show the target.
+            drawTarget(_display, _screenX, _screenY, BLACK);
+            _display->partialUpdate();
+
+            // Wait for the touch.
+            uint16_t _touchX, _touchY;
+            bool _ret = readTarget(_touch, &_touchX, &_touchY);
+
+            // Remove the target.
+            drawTarget(_display, _screenX, _screenY, WHITE);
+
+            if (!_ret)
+            {
+                buildTable();
+                _display->partialUpdate();
+                return false;
+            }
+
+            // Save the error (reported position - node position).
+            _dx[_row][_col] = (int16_t)_touchX - (int16_t)_nodeX;
+            _dy[_row][_col] = (int16_t)_touchY - (int16_t)_nodeY;
+        }
+    }
+
+    // Errors are known at node positions, but correction is needed at reported positions.
+    buildTable();
+    invertMesh();
+    _display->partialUpdate();
+
+    return true;
+}
+
+/**
+ * @brief       Store mesh into flash (NVS).
+ * 
+ * @return      bool
+ *              true - Mesh is stored.
+ *              false - Mesh size not set or NVS write failed.
+ */
+bool CypressTouchCorrection::save()
+{
+    // Mesh not set?
+    if (_cols < 2 || _rows < 2) return false;
+
+    struct cypressTouchMeshStorage _storage;
+    _storage.magic = CYPRESS_TOUCH_MESH_MAGIC;
+    _storage.cols = _cols;
+    _storage.rows = _rows;
+    memcpy(_storage.dx, _dx, sizeof(_dx));
+    memcpy(_storage.dy, _dy, sizeof(_dy));
+
+    Preferences _prefs;
+    if (!_prefs.begin(CYPRESS_TOUCH_MESH_NVS_NAME, false)) return false;
+    size_t _len = _prefs.putBytes(CYPRESS_TOUCH_MESH_NVS_KEY, &_storage, sizeof(_storage));
+    _prefs.end();
+
+    return _len == sizeof(_storage) ? true : false;
+}
+
+/**
+ * @brief       Load mesh from flash (NVS).
+ * 
+ * @return      bool
+ *              true - Mesh is loaded.
+ *              false - There is no stored mesh or it's not valid.
+ */
+bool CypressTouchCorrection::load()
+{
+    struct cypressTouchMeshStorage _storage;
+
+    Preferences _prefs;
+    if (!_prefs.begin(CYPRESS_TOUCH_MESH_NVS_NAME, true)) return false;
+    size_t _len = _prefs.getBytes(CYPRESS_TOUCH_MESH_NVS_KEY, &_storage, sizeof(_storage));
+    _prefs.end();
+
+    // Check if the stored mesh is valid.
+    if (_len != sizeof(_storage) || _storage.magic != CYPRESS_TOUCH_MESH_MAGIC) return false;
+    if (!setGrid(_storage.cols, _storage.rows)) return false;
+
+    memcpy(_dx, _storage.dx, sizeof(_dx));
+    memcpy(_dy, _storage.dy, sizeof(_dy));
+    buildTable();
+
+    return true;
+}
+
+/**
+ * @brief       Calculate bilinear interpolation coefficients of each cell from the offsets in its
+ *              four nodes (p00 - top left, p10 - top right, p01 - bottom left, p11 - bottom right):
+ *              a = p00, b = p10 - p00, c = p01 - p00, d = p11 - p10 - p01 + p00.
+ * 
+ */
+void CypressTouchCorrection::buildTable()
+{
+    for (int _row = 0; _row < _rows - 1; _row++)
+    {
+        for (int _col = 0; _col < _cols - 1; _col++)
+        {
+            struct cypressTouchMeshCell *_cx = &_cellX[_row][_col];
+            _cx->a = _dx[_row][_col];
+            _cx->b = _dx[_row][_col + 1] - _dx[_row][_col];
+            _cx->c = _dx[_row + 1][_col] - _dx[_row][_col];
+            _cx->d = _dx[_row + 1][_col + 1] - _dx[_row][_col + 1] - _dx[_row + 1][_col] + _dx[_row][_col];
+
+            struct cypressTouchMeshCell *_cy = &_cellY[_row][_col];
+            _cy->a = _dy[_row][_col];
+            _cy->b = _dy[_row][_col + 1] - _dy[_row][_col];
+            _cy->c = _dy[_row + 1][_col] - _dy[_row][_col];
+            _cy->d = _dy[_row + 1][_col + 1] - _dy[_row][_col + 1] - _dy[_row + 1][_col] + _dy[_row][_col];
+        }
+    }
+}
+
+/**
+ * @brief       Get interpolated offset for the point. Offset is bilinearly interpolated between
+ *              four mesh nodes around the point by using precomputed cell coefficients (two
+ *              multiplies for the position inside the mesh and four for each axis).
+ * 
+ * @param       uint16_t _x, uint16_t _y
+ *              Raw touch position.
+ * @param       int32_t *_dx, int32_t *_dy
+ *              Interpolated offsets will be stored here.
+ */
+void CypressTouchCorrection::interpolate(uint16_t _x, uint16_t _y, int32_t *_dx, int32_t *_dy)
+{
+    // Position inside the mesh in 1/256 of the cell.
+    uint32_t _fx = ((uint32_t)_x * _scaleX) >> 8;
+    uint32_t _fy = ((uint32_t)_y * _scaleY) >> 8;
+
+    // Cell and position inside the cell (0 - 256). Points on (or out of) the last node use the last cell.
+    int _col = _fx >> 8;
+    int _row = _fy >> 8;
+    int32_t _u = _fx & 0xFF;
+    int32_t _v = _fy & 0xFF;
+    if (_col >= _cols - 1)
+    {
+        _col = _cols - 2;
+        _u = 256;
+    }
+    if (_row >= _rows - 1)
+    {
+        _row = _rows - 2;
+        _v = 256;
+    }
+
+    // Interpolate the offsets.
+    int32_t _uv = (_u * _v) >> 8;
+    struct cypressTouchMeshCell *_cx = &_cellX[_row][_col];
+    struct cypressTouchMeshCell *_cy = &_cellY[_row][_col];
+    *_dx = _cx->a + ((_cx->b * _u + _cx->c * _v + _cx->d * _uv) >> 8);
+    *_dy = _cy->a + ((_cy->b * _u + _cy->c * _v + _cy->d * _uv) >> 8);
+}
+
+/**
+ * @brief       Convert measured node errors (reported - real position, stored in the mesh) into
+ *              correction offsets. Real position t of the point reported at node g is found by
+ *              iterating t = g - error(t), correction offset of the node is t - g.
+ * 
+ */
+void CypressTouchCorrection::invertMesh()
+{
+    int16_t _corrX[CYPRESS_TOUCH_MESH_MAX_ROWS][CYPRESS_TOUCH_MESH_MAX_COLS];
+    int16_t _corrY[CYPRESS_TOUCH_MESH_MAX_ROWS][CYPRESS_TOUCH_MESH_MAX_COLS];
+
+    for (int _row = 0; _row < _rows; _row++)
+    {
+        for (int _col = 0; _col < _cols; _col++)
+        {
+            uint16_t _gx, _gy;
+            getNodePosition(_col, _row, &_gx, &_gy);
+
+            // Start from the node and iterate (converges as long as the error changes slower than the position).
+            int32_t _tx = _gx;
+            int32_t _ty = _gy;
+            for (int i = 0; i < 8; i++)
+            {
+                int32_t _ex, _ey;
+                interpolate(constrain(_tx, (int32_t)0, (int32_t)CYPRESS_TOUCH_MAX_X), constrain(_ty, (int32_t)0, (int32_t)CYPRESS_TOUCH_MAX_Y), &_ex, &_ey);
+                _tx = (int32_t)_gx - _ex;
+                _ty = (int32_t)_gy - _ey;
+            }
+
+            _corrX[_row][_col] = _tx - _gx;
+            _corrY[_row][_col] = _ty - _gy;
+        }
+    }
+
+    // Use correction offsets.
+    memcpy(_dx, _corrX, sizeof(_dx));
+    memcpy(_dy, _corrY, sizeof(_dy));
+    buildTable();
+}
+
+/**
+ * @brief       Convert raw touch position into screen position. Touch is flipped first, then X and Y
+ *              are swapped and at the end position is mapped to the screen size.
+ * 
+ * @param       uint16_t _x, uint16_t _y
+ *              Raw touch position.
+ * @param       uint16_t _xSize, uint16_t _ySize
+ *              Screen size in pixels.
+ * @param       bool _flipX, bool _flipY, bool _swapXY
+ *              Same as in CypressTouch::scale().
+ * @param       int *_sx, int *_sy
+ *              Screen position will be stored here.
+ */
+void CypressTouchCorrection::rawToScreen(uint16_t _x, uint16_t _y, uint16_t _xSize, uint16_t _ySize, bool _flipX, bool _flipY, bool _swapXY, int *_sx, int *_sy)
+{
+    int _rawX = _flipX ? CYPRESS_TOUCH_MAX_X - _x : _x;
+    int _rawY = _flipY ? CYPRESS_TOUCH_MAX_Y - _y : _y;
+    int _maxX = CYPRESS_TOUCH_MAX_X;
+    int _maxY = CYPRESS_TOUCH_MAX_Y;
+
+    if (_swapXY)
+    {
+        int _temp = _rawX;
+        _rawX = _rawY;
+        _rawY = _temp;
+        _maxX = CYPRESS_TOUCH_MAX_Y;
+        _maxY = CYPRESS_TOUCH_MAX_X;
+    }
+
+    *_sx = map(_rawX, 0, _maxX, 0, _xSize - 1);
+    *_sy = map(_rawY, 0, _maxY, 0, _ySize - 1);
+}
+
+/**
+ * @brief       Draw or erase calibration target (crosshair with a circle).
+ * 
+ * @param       Inkplate *_display
+ *              Inkplate library object.
+ * @param       int _x, int _y
+ *              Target center on the screen.
+ * @param       int _color
+ *              BLACK to draw the target, WHITE to erase it.
+ */
+void CypressTouchCorrection::drawTarget(Inkplate *_display, int _x, int _y, int _color)
+{
+    _display->drawLine(_x - CYPRESS_TOUCH_MESH_CAL_SIZE, _y, _x + CYPRESS_TOUCH_MESH_CAL_SIZE, _y, _color);
+    _display->drawLine(_x, _y - CYPRESS_TOUCH_MESH_CAL_SIZE, _x, _y + CYPRESS_TOUCH_MESH_CAL_SIZE, _color);
+    _display->drawCircle(_x, _y, CYPRESS_TOUCH_MESH_CAL_SIZE / 2, _color);
+}
+
+/**
+ * @brief       Wait for the single finger touch and return its average raw position after the
+ *              finger is released.
+ * 
+ * @param       CypressTouch *_touch
+ *              Cypress touch library object.
+ * @param       uint16_t *_x, uint16_t *_y
+ *              Average raw touch position will be stored here.
+ * 
+ * @return      bool
+ *              true - Touch position is read.
+ *              false - Timeout.
+ */
+bool CypressTouchCorrection::readTarget(CypressTouch *_touch, uint16_t *_x, uint16_t *_y)
+{
+    unsigned long _timer = millis();
+    uint32_t _sumX = 0;
+    uint32_t _sumY = 0;
+    uint32_t _samples = 0;
+
+    while ((unsigned long)(millis() - _timer) < CYPRESS_TOUCH_MESH_CAL_TIMEOUT)
+    {
+        struct cypressTouchData _touchData;
+        if (_touch->available() && _touch->getTouchData(&_touchData))
+        {
+            if (_touchData.fingers == 1)
+            {
+                // Finger on the target, add it to the average.
+                _sumX += _touchData.x[0];
+                _sumY += _touchData.y[0];
+                _samples++;
+            }
+            else if (_touchData.fingers == 0 && _samples)
+            {
+                // Finger released, return the average.
+                *_x = _sumX / _samples;
+                *_y = _sumY / _samples;
+                return true;
+            }
+        }
+
+        delay(1);
+    }
+
+    // Got here? Timeout.
+    return false;
+}
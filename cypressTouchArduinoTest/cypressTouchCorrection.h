@@ -0,0 +1,104 @@
+#ifndef __CYPRESSTOUCHCORRECTION_H__
+#define __CYPRESSTOUCHCORRECTION_H__
+
+// Include main Arduino header file.
+#include <Arduino.h>
+
+// Include ESP32 Preferences library (correction mesh is stored into NVS flash).
+#include <Preferences.h>
+
+// Include main Cypress touch library header.
+#include "cypressTouch.h"
+
+// Max. number of the correction mesh nodes in each direction.
+#define CYPRESS_TOUCH_MESH_MAX_COLS     12
+#define CYPRESS_TOUCH_MESH_MAX_ROWS     12
+
+// NVS namespace and key for the stored mesh.
+#define CYPRESS_TOUCH_MESH_NVS_NAME     "cyTouchMesh"
+#define CYPRESS_TOUCH_MESH_NVS_KEY      "mesh"
+
+// Magic number of the stored mesh (changes if the stored format changes).
+#define CYPRESS_TOUCH_MESH_MAGIC        0x4D53
+
+// How long calibration waits for the touch on each target (in ms) and target crosshair size (in pixels).
+#define CYPRESS_TOUCH_MESH_CAL_TIMEOUT  30000
+#define CYPRESS_TOUCH_MESH_CAL_SIZE     15
+
+class CypressTouchCorrection
+{
+    public:
+        // Library constructor.
+        CypressTouchCorrection();
+
+        // Set the number of the mesh nodes (all offsets are cleared).
+        bool setGrid(uint8_t _cols, uint8_t _rows);
+
+        // Set measured offset of one mesh node.
+        bool setOffset(uint8_t _col, uint8_t _row, int16_t _dx, int16_t _dy);
+
+        // Get raw touch position of the mesh node.
+        void getNodePosition(uint8_t _col, uint8_t _row, uint16_t *_x, uint16_t *_y);
+
+        // Correct all contacts in the touch report.
+        void apply(struct cypressTouchData *_touchData);
+
+        // Correct one point.
+        void applyPoint(uint16_t *_x, uint16_t *_y);
+
+        // Guided on-screen calibration.
+        bool calibrate(CypressTouch *_touch, Inkplate *_display, uint16_t _xSize, uint16_t _ySize, bool _flipX, bool _flipY, bool _swapXY);
+
+        // Store mesh into flash.
+        bool save();
+
+        // Load mesh from flash.
+        bool load();
+
+    private:
+        // Bilinear interpolation coefficients of one cell for one axis:
+        // offset = a + (b * u + c * v + ((d * u * v) >> 8)) >> 8, where u and v are 0 - 255 inside the cell.
+        struct cypressTouchMeshCell
+        {
+            int16_t a;
+            int16_t b;
+            int16_t c;
+            int16_t d;
+        };
+
+        // Number of the mesh nodes.
+        uint8_t _cols = 0;
+        uint8_t _rows = 0;
+
+        // Measured offsets in the mesh nodes.
+        int16_t _dx[CYPRESS_TOUCH_MESH_MAX_ROWS][CYPRESS_TOUCH_MESH_MAX_COLS];
+        int16_t _dy[CYPRESS_TOUCH_MESH_MAX_ROWS][CYPRESS_TOUCH_MESH_MAX_COLS];
+
+        // Precomputed cell coefficients for X and Y offsets.
+        struct cypressTouchMeshCell _cellX[CYPRESS_TOUCH_MESH_MAX_ROWS - 1][CYPRESS_TOUCH_MESH_MAX_COLS - 1];
+        struct cypressTouchMeshCell _cellY[CYPRESS_TOUCH_MESH_MAX_ROWS - 1][CYPRESS_TOUCH_MESH_MAX_COLS - 1];
+
+        // Raw position to cell position scale (Q16, result is in 1/256 of the cell).
+        uint32_t _scaleX = 0;
+        uint32_t _scaleY = 0;
+
+        // Calculate cell coefficients from the node offsets.
+        void buildTable();
+
+        // Get interpolated offset for the point.
+        void interpolate(uint16_t _x, uint16_t _y, int32_t *_dx, int32_t *_dy);
+
+        // Convert measured node errors into correction offsets.
+        void invertMesh();
+
+        // Convert raw touch position into screen position (same parameters as scale()).
+        void rawToScreen(uint16_t _x, uint16_t _y, uint16_t _xSize, uint16_t _ySize, bool _flipX, bool _flipY, bool _swapXY, int *_sx, int *_sy);
+
+        // Draw or erase calibration target.
+        void drawTarget(Inkplate *_display, int _x, int _y, int _color);
+
+        // Wait for the touch and return average raw position.
+        bool readTarget(CypressTouch *_touch, uint16_t *_x, uint16_t *_y);
+};
+
+#endif
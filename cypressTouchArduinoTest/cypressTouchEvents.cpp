@@ -0,0 +1,357 @@
+// Include main header file of the touch event dispatcher.
+#include "cypressTouchEvents.h"
+
+/**
+ * @brief Constructor for a new CypressTouchEvents object.
+ * 
+ */
+CypressTouchEvents::CypressTouchEvents()
+{
+    memset(_subscribers, 0, sizeof(_subscribers));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**
+ * @brief       Initialize touch event dispatcher.
+ * 
+ * @param       CypressTouch *_touch
+ *              Pointer to the already initialized Cypress touch library object.
+ * 
+ * @return      bool
+ *              true - Initialization ok.
+ *              false - Initialization failed (null-pointer or mutex can't be created).
+ */
+bool CypressTouchEvents::begin(CypressTouch *_touch)
+{
+    // Check for the null-pointer trap.
+    if (_touch == NULL) return false;
+
+    // Copy library object into the internal one.
+    _touchPtr = _touch;
+
+    // Create mutex for the subscriber list (only once).
+    if (_lock == NULL) _lock = xSemaphoreCreateMutex();
+
+    return _lock != NULL ? true : false;
+}
+
+/**
+ * @brief       Add new subscriber with its own event queue. Use receive() from the subscriber task
+ *              to get the events.
+ * 
+ * @param       uint8_t _filter
+ *              Event types that subscriber wants to get (CYPRESS_TOUCH_EVENT_PRESS, CYPRESS_TOUCH_EVENT_MOVE,
+ *              CYPRESS_TOUCH_EVENT_RELEASE or CYPRESS_TOUCH_EVENT_ALL).
+ * @param       int _queueLen
+ *              Max. number of events in the queue. If the queue is full, new events are dropped.
+ * 
+ * @return      int
+ *              Subscriber ID or -1 if there is no free subscriber slot.
+ */
+int CypressTouchEvents::subscribe(uint8_t _filter, int _queueLen)
+{
+    // Check the parameters.
+    if (_queueLen <= 0) return -1;
+
+    // Queue is only allocated here, dispatch only copies event record into it.
+    QueueHandle_t _queue = xQueueCreate(_queueLen, sizeof(struct cypressTouchEvent));
+    if (_queue == NULL) return -1;
+
+    int _id = addSubscriber(_filter, _queue, NULL, NULL);
+
+    // No free slot? Free the queue.
+    if (_id < 0) vQueueDelete(_queue);
+
+    return _id;
+}
+
+/**
+ * @brief       Add new subscriber with callback function.
+ * 
+ * @param       uint8_t _filter
+ *              Event types that subscriber wants to get.
+ * @param       void (*_callback)(const struct cypressTouchEvent *_event, void *_arg)
+ *              Callback function. It's called from the task that calls dispatch(), so keep it short.
+ * @param       void *_arg
+ *              User argument passed to the callback.
+ * 
+ * @return      int
+ *              Subscriber ID or -1 if there is no free subscriber slot.
+ */
+int CypressTouchEvents::subscribe(uint8_t _filter, void (*_callback)(const struct cypressTouchEvent *_event, void *_arg), void *_arg)
+{
+    // Check for the null-pointer trap.
+    if (_callback == NULL) return -1;
+
+    return addSubscriber(_filter, NULL, _callback, _arg);
+}
+
+/**
+ * @brief       Remove the subscriber and free its queue.
+ * 
+ * @param       int _id
+ *              Subscriber ID returned by subscribe().
+ * 
+ * @note        Queue is deleted here, so subscriber with the queue must unsubscribe from its own task
+ *              (the one that calls receive()), never while another task is waiting in receive().
+ *              Callback subscriber can still get one event that was already being dispatched.
+ */
+void CypressTouchEvents::unsubscribe(int _id)
+{
+    // Check the parameters.
+    if (_id < 0 || _id >= CYPRESS_TOUCH_MAX_SUBSCRIBERS || _lock == NULL) return;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+
+    if (_subscribers[_id].used)
+    {
+        if (_subscribers[_id].queue != NULL) vQueueDelete(_subscribers[_id].queue);
+        memset(&_subscribers[_id], 0, sizeof(struct cypressTouchSubscriber));
+        _subscriberCount--;
+    }
+
+    xSemaphoreGive(_lock);
+}
+
+/**
+ * @brief       Get the next event from the subscriber queue.
+ * 
+ * @param       int _id
+ *              Subscriber ID returned by subscribe().
+ * @param       struct cypressTouchEvent *_event
+ *              Defined in cypressTouchTypedefs.h, event will be stored here.
+ * @param       uint32_t _timeout
+ *              How long to wait for the event in milliseconds (portMAX_DELAY to wait forever).
+ * 
+ * @return      bool
+ *              true - New event is received.
+ *              false - No event (timeout) or subscriber does not have a queue.
+ * 
+ * @note        Call it only from the subscriber task (see unsubscribe()).
+ */
+bool CypressTouchEvents::receive(int _id, struct cypressTouchEvent *_event, uint32_t _timeout)
+{
+    // Check the parameters.
+    if (_id < 0 || _id >= CYPRESS_TOUCH_MAX_SUBSCRIBERS || _event == NULL || _lock == NULL) return false;
+
+    // Get the queue handle.
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    QueueHandle_t _queue = _subscribers[_id].used ? _subscribers[_id].queue : NULL;
+    xSemaphoreGive(_lock);
+    if (_queue == NULL) return false;
+
+    TickType_t _ticks = _timeout == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(_timeout);
+    return xQueueReceive(_queue, _event, _ticks) == pdTRUE ? true : false;
+}
+
+/**
+ * @brief       Read new touch report from the Touchscreen Controller (if there is one) and send
+ *              it to all subscribers. Only one task should call this method.
+ * 
+ * @return      bool
+ *              true - New event has been dispatched.
+ *              false - No new touch data, touch data read has failed or report is not an event (no
+ *              fingers after the release).
+ */
+bool CypressTouchEvents::dispatch()
+{
+    // Check for the null-pointer trap.
+    if (_touchPtr == NULL) return false;
+
+    // Check for the new data.
+    if (!_touchPtr->available()) return false;
+
+    // Read it.
+    struct cypressTouchData _touchData;
+    if (!_touchPtr->getTouchData(&_touchData)) return false;
+
+    // Make event and send it to everyone.
+    struct cypressTouchEvent _event;
+    if (!makeEvent(&_touchData, &_event)) return false;
+    publish(&_event);
+
+    return true;
+}
+
+/**
+ * @brief       Send the event to all subscribers with the matching filter. Only the event record
+ *              is copied into each queue. Callbacks are called after the subscriber list is unlocked,
+ *              so callback can subscribe, unsubscribe or get the statistics. Dispatch time is measured
+ *              for the statistics.
+ * 
+ * @param       const struct cypressTouchEvent *_event
+ *              Defined in cypressTouchTypedefs.h, event that needs to be sent.
+ */
+void CypressTouchEvents::publish(const struct cypressTouchEvent *_event)
+{
+    // Check for the null-pointer trap.
+    if (_event == NULL || _lock == NULL) return;
+
+    // Capture the time when dispatch started.
+    uint32_t _timer = micros();
+
+    // Callbacks that need to be called (copied while the list is locked).
+    void (*_callbacks[CYPRESS_TOUCH_MAX_SUBSCRIBERS])(const struct cypressTouchEvent *_event, void *_arg);
+    void *_args[CYPRESS_TOUCH_MAX_SUBSCRIBERS];
+    int _callbackCount = 0;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+
+    for (int i = 0; i < CYPRESS_TOUCH_MAX_SUBSCRIBERS; i++)
+    {
+        struct cypressTouchSubscriber *_sub = &_subscribers[i];
+
+        // Skip empty slots and subscribers that don't want this type of the event.
+        if (!_sub->used || !(_sub->filter & _event->type)) continue;
+
+        if (_sub->queue != NULL)
+        {
+            // Do not block the dispatching task, drop the event if queue is full.
+            if (xQueueSend(_sub->queue, _event, 0) != pdTRUE)
+            {
+                _sub->dropped++;
+                _stats.dropped++;
+            }
+        }
+        else
+        {
+            _callbacks[_callbackCount] = _sub->callback;
+            _args[_callbackCount] = _sub->arg;
+            _callbackCount++;
+        }
+    }
+
+    uint8_t _count = _subscriberCount;
+    xSemaphoreGive(_lock);
+
+    // Call the callbacks without the lock.
+    for (int i = 0; i < _callbackCount; i++)
+    {
+        _callbacks[i](_event, _args[i]);
+    }
+
+    // Update the statistics.
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    uint32_t _time = micros() - _timer;
+    _stats.events++;
+    _stats.subscribers = _count;
+    _stats.lastDispatchTime = _time;
+    if (_time > _stats.maxDispatchTime) _stats.maxDispatchTime = _time;
+    _stats.eventsPerCount[_count]++;
+    _stats.timePerCount[_count] += _time;
+
+    xSemaphoreGive(_lock);
+}
+
+/**
+ * @brief       Get dispatch statistics. Average dispatch time for N subscribers is
+ *              timePerCount[N] / eventsPerCount[N].
+ * 
+ * @param       struct cypressTouchDispatchStats *_stats
+ *              Statistics will be copied here.
+ */
+void CypressTouchEvents::getStats(struct cypressTouchDispatchStats *_stats)
+{
+    // Check for the null-pointer trap.
+    if (_stats == NULL || _lock == NULL) return;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    memcpy(_stats, &this->_stats, sizeof(struct cypressTouchDispatchStats));
+    xSemaphoreGive(_lock);
+}
+
+/**
+ * @brief       Clear dispatch statistics.
+ * 
+ */
+void CypressTouchEvents::clearStats()
+{
+    if (_lock == NULL) return;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    memset(&_stats, 0, sizeof(_stats));
+    xSemaphoreGive(_lock);
+}
+
+/**
+ * @brief       Convert touch report into event record. Event type is detected from the number
+ *              of fingers in the current and previous report.
+ * 
+ * @param       struct cypressTouchData *_touchData
+ *              Defined in cypressTouchTypedefs.h, touch report from getTouchData().
+ * @param       struct cypressTouchEvent *_event
+ *              Defined in cypressTouchTypedefs.h, event record will be stored here.
+ * 
+ * @return      bool
+ *              true - Report is an event.
+ *              false - No fingers now and in the previous report (controller can send more than one
+ *              report after the release), there is nothing to send.
+ */
+bool CypressTouchEvents::makeEvent(struct cypressTouchData *_touchData, struct cypressTouchEvent *_event)
+{
+    // No fingers before and now - release has already been sent.
+    if (_touchData->fingers == 0 && _lastFingers == 0) return false;
+
+    // More fingers than before - new press, less fingers - release, otherwise it's move.
+    if (_touchData->fingers > _lastFingers)
+    {
+        _event->type = CYPRESS_TOUCH_EVENT_PRESS;
+    }
+    else if (_touchData->fingers < _lastFingers)
+    {
+        _event->type = CYPRESS_TOUCH_EVENT_RELEASE;
+    }
+    else
+    {
+        _event->type = CYPRESS_TOUCH_EVENT_MOVE;
+    }
+    _lastFingers = _touchData->fingers;
+
+    // Copy the rest of the report.
+    _event->fingers = _touchData->fingers;
+    for (int i = 0; i < 2; i++)
+    {
+        _event->x[i] = _touchData->x[i];
+        _event->y[i] = _touchData->y[i];
+        _event->z[i] = _touchData->z[i];
+    }
+    _event->timestamp = millis();
+
+    return true;
+}
+
+/**
+ * @brief       Find free subscriber slot and fill it.
+ * 
+ * @return      int
+ *              Subscriber ID or -1 if there is no free subscriber slot.
+ */
+int CypressTouchEvents::addSubscriber(uint8_t _filter, QueueHandle_t _queue, void (*_callback)(const struct cypressTouchEvent *_event, void *_arg), void *_arg)
+{
+    // Library must be initialized first.
+    if (_lock == NULL) return -1;
+
+    int _id = -1;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+
+    for (int i = 0; i < CYPRESS_TOUCH_MAX_SUBSCRIBERS; i++)
+    {
+        if (!_subscribers[i].used)
+        {
+            _subscribers[i].used = true;
+            _subscribers[i].filter = _filter;
+            _subscribers[i].queue = _queue;
+            _subscribers[i].callback = _callback;
+            _subscribers[i].arg = _arg;
+            _subscribers[i].dropped = 0;
+            _subscriberCount++;
+            _id = i;
+            break;
+        }
+    }
+
+    xSemaphoreGive(_lock);
+
+    return _id;
+}
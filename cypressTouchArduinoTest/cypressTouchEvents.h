@@ -0,0 +1,108 @@
+#ifndef __CYPRESSTOUCHEVENTS_H__
+#define __CYPRESSTOUCHEVENTS_H__
+
+// Include main Arduino header file.
+#include <Arduino.h>
+
+// Include FreeRTOS queues and semaphores (needed for multiple tasks).
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+// Include main Cypress touch library header.
+#include "cypressTouch.h"
+
+// Touch event types (can be OR-ed together for the subscriber filter).
+#define CYPRESS_TOUCH_EVENT_PRESS       0x01
+#define CYPRESS_TOUCH_EVENT_MOVE        0x02
+#define CYPRESS_TOUCH_EVENT_RELEASE     0x04
+#define CYPRESS_TOUCH_EVENT_ALL         0x07
+
+// Max number of the subscribers at the same time.
+#define CYPRESS_TOUCH_MAX_SUBSCRIBERS   8
+
+// Touch event dispatch statistics. Dispatch time is in microseconds.
+struct cypressTouchDispatchStats
+{
+    uint32_t events;
+    uint32_t dropped;
+    uint8_t subscribers;
+    uint32_t lastDispatchTime;
+    uint32_t maxDispatchTime;
+
+    // Number of events and total dispatch time for each subscriber count.
+    uint32_t eventsPerCount[CYPRESS_TOUCH_MAX_SUBSCRIBERS + 1];
+    uint32_t timePerCount[CYPRESS_TOUCH_MAX_SUBSCRIBERS + 1];
+};
+
+class CypressTouchEvents
+{
+    public:
+        // Library constructor.
+        CypressTouchEvents();
+
+        // Initialization function.
+        bool begin(CypressTouch *_touch);
+
+        // Subscribe with own event queue.
+        int subscribe(uint8_t _filter, int _queueLen);
+
+        // Subscribe with callback (called from the dispatching task).
+        int subscribe(uint8_t _filter, void (*_callback)(const struct cypressTouchEvent *_event, void *_arg), void *_arg = NULL);
+
+        // Remove the subscriber.
+        void unsubscribe(int _id);
+
+        // Get the next event from the subscriber queue.
+        bool receive(int _id, struct cypressTouchEvent *_event, uint32_t _timeout = 0);
+
+        // Read new touch report (if available) and send it to all subscribers.
+        bool dispatch();
+
+        // Send already made event to all subscribers.
+        void publish(const struct cypressTouchEvent *_event);
+
+        // Get dispatch statistics.
+        void getStats(struct cypressTouchDispatchStats *_stats);
+
+        // Clear dispatch statistics.
+        void clearStats();
+
+        // Convert touch report into event record.
+        bool makeEvent(struct cypressTouchData *_touchData, struct cypressTouchEvent *_event);
+
+    private:
+        // Subscriber data.
+        struct cypressTouchSubscriber
+        {
+            bool used;
+            uint8_t filter;
+            QueueHandle_t queue;
+            void (*callback)(const struct cypressTouchEvent *_event, void *_arg);
+            void *arg;
+            uint32_t dropped;
+        };
+
+        // Cypress touch library object pointer.
+        CypressTouch *_touchPtr = NULL;
+
+        // Mutex for the subscriber list.
+        SemaphoreHandle_t _lock = NULL;
+
+        // Subscriber list.
+        struct cypressTouchSubscriber _subscribers[CYPRESS_TOUCH_MAX_SUBSCRIBERS];
+
+        // Number of active subscribers.
+        uint8_t _subscriberCount = 0;
+
+        // Number of fingers from the last report (needed for event type).
+        uint8_t _lastFingers = 0;
+
+        // Dispatch statistics.
+        struct cypressTouchDispatchStats _stats;
+
+        // Find free subscriber slot and fill it.
+        int addSubscriber(uint8_t _filter, QueueHandle_t _queue, void (*_callback)(const struct cypressTouchEvent *_event, void *_arg), void *_arg);
+};
+
+#endif
@@ -0,0 +1,257 @@
+// Include main header file of the touch heatmap accumulator.
+#include "cypressTouchHeatmap.h"
+
+/**
+ * @brief Constructor for a new CypressTouchHeatmap object.
+ * 
+ */
+CypressTouchHeatmap::CypressTouchHeatmap()
+{
+    // Precalculate the scale, so there is no division in the report path.
+    _scaleX = ((uint32_t)CYPRESS_TOUCH_HEATMAP_COLS << 16) / (CYPRESS_TOUCH_MAX_X + 1);
+    _scaleY = ((uint32_t)CYPRESS_TOUCH_HEATMAP_ROWS << 16) / (CYPRESS_TOUCH_MAX_Y + 1);
+
+    clearAll();
+}
+
+/**
+ * @brief       Select context that receives new touches. Call it every time application changes the
+ *              screen, so touches of each screen are kept separately.
+ * 
+ * @param       uint8_t _context
+ *              Context index (0 - CYPRESS_TOUCH_HEATMAP_CONTEXTS - 1).
+ * 
+ * @return      bool
+ *              true - Context is selected.
+ *              false - Context index is out of range.
+ */
+bool CypressTouchHeatmap::setContext(uint8_t _context)
+{
+    if (_context >= CYPRESS_TOUCH_HEATMAP_CONTEXTS) return false;
+
+    this->_context = _context;
+
+    // Contacts that are still on the screen are counted again in the new context.
+    _lastCell[0] = CYPRESS_TOUCH_HEATMAP_NO_CELL;
+    _lastCell[1] = CYPRESS_TOUCH_HEATMAP_NO_CELL;
+
+    return true;
+}
+
+/**
+ * @brief       Get currently selected context.
+ * 
+ * @return      uint8_t
+ *              Context index.
+ */
+uint8_t CypressTouchHeatmap::getContext()
+{
+    return _context;
+}
+
+/**
+ * @brief       Add all contacts of the touch report to the selected context. Call it for every report
+ *              read with getTouchData() (before scale()), also for the reports without fingers, so
+ *              lifted contacts are detected. Contact is counted on touch down, when it moves into other
+ *              cell and every CYPRESS_TOUCH_HEATMAP_DWELL_MS while it stays in the same cell, so the
+ *              heatmap shows touches and dwell time, not the report rate. It costs the same for every
+ *              report (no loops over the grid, no division), and the cost is measured in CPU cycles
+ *              (see getStats()).
+ * 
+ * @param       struct cypressTouchData *_touchData
+ *              Defined in cypressTouchTypedefs.h, touch report.
+ */
+void CypressTouchHeatmap::addReport(struct cypressTouchData *_touchData)
+{
+    // Check for the null-pointer trap.
+    if (_touchData == NULL) return;
+
+    uint32_t _startCycles = ESP.getCycleCount();
+
+    // Add each contact (Cypress controller reports up to two), forget the lifted ones.
+    uint8_t _fingers = _touchData->fingers > 2 ? 2 : _touchData->fingers;
+    for (int i = 0; i < 2; i++)
+    {
+        if (i < _fingers)
+        {
+            addPoint(i, _touchData->x[i], _touchData->y[i]);
+        }
+        else
+        {
+            _lastCell[i] = CYPRESS_TOUCH_HEATMAP_NO_CELL;
+        }
+    }
+
+    // Update the cost stats.
+    uint32_t _cycles = ESP.getCycleCount() - _startCycles;
+    _stats.reports++;
+    _stats.lastCycles = _cycles;
+    _stats.totalCycles += _cycles;
+    if (_cycles > _stats.maxCycles) _stats.maxCycles = _cycles;
+}
+
+/**
+ * @brief       Get value of one heatmap cell.
+ * 
+ * @param       uint8_t _context
+ *              Context index.
+ * @param       uint8_t _col
+ *              Cell column (0 - CYPRESS_TOUCH_HEATMAP_COLS - 1).
+ * @param       uint8_t _row
+ *              Cell row (0 - CYPRESS_TOUCH_HEATMAP_ROWS - 1).
+ * 
+ * @return      uint8_t
+ *              Number of touches and dwell intervals in the cell (saturates at 255), 0 if the index is
+ *              out of range.
+ */
+uint8_t CypressTouchHeatmap::getCell(uint8_t _context, uint8_t _col, uint8_t _row)
+{
+    if (_context >= CYPRESS_TOUCH_HEATMAP_CONTEXTS || _col >= CYPRESS_TOUCH_HEATMAP_COLS || _row >= CYPRESS_TOUCH_HEATMAP_ROWS)
+        return 0;
+
+    return _cells[_context][_row][_col];
+}
+
+/**
+ * @brief       Clear one context.
+ * 
+ * @param       uint8_t _context
+ *              Context index.
+ * 
+ * @return      bool
+ *              true - Context is cleared.
+ *              false - Context index is out of range.
+ */
+bool CypressTouchHeatmap::clear(uint8_t _context)
+{
+    if (_context >= CYPRESS_TOUCH_HEATMAP_CONTEXTS) return false;
+
+    memset(_cells[_context], 0, sizeof(_cells[_context]));
+
+    return true;
+}
+
+/**
+ * @brief       Clear all contexts and stats.
+ * 
+ */
+void CypressTouchHeatmap::clearAll()
+{
+    memset(_cells, 0, sizeof(_cells));
+    memset(&_stats, 0, sizeof(_stats));
+    _lastCell[0] = CYPRESS_TOUCH_HEATMAP_NO_CELL;
+    _lastCell[1] = CYPRESS_TOUCH_HEATMAP_NO_CELL;
+}
+
+/**
+ * @brief       Export one context in compact format. First two bytes are number of columns and rows,
+ *              followed by the cells row by row. Non-zero cell is stored as it is, run of the zero
+ *              cells is stored as 0x00 followed by the run length (1 - 255). Mostly empty heatmap
+ *              usually takes only a few hundred bytes, but if zero and non-zero cells alternate it
+ *              takes 1.5 bytes per cell.
+ * 
+ * @param       uint8_t _context
+ *              Context index.
+ * @param       uint8_t *_buffer
+ *              Buffer for the exported heatmap.
+ * @param       size_t _len
+ *              Size of the buffer (CYPRESS_TOUCH_HEATMAP_EXPORT_MAX is always enough).
+ * 
+ * @return      size_t
+ *              Number of bytes written, 0 if the buffer is too small or the context is out of range.
+ */
+size_t CypressTouchHeatmap::exportContext(uint8_t _context, uint8_t *_buffer, size_t _len)
+{
+    // Check for the null-pointer trap and the context index.
+    if (_buffer == NULL || _context >= CYPRESS_TOUCH_HEATMAP_CONTEXTS || _len < 2) return 0;
+
+    // Write the header.
+    size_t _n = 0;
+    _buffer[_n++] = CYPRESS_TOUCH_HEATMAP_COLS;
+    _buffer[_n++] = CYPRESS_TOUCH_HEATMAP_ROWS;
+
+    // Encode all cells (as one array, so zero runs can go over the row end).
+    const uint8_t *_src = &_cells[_context][0][0];
+    int _total = CYPRESS_TOUCH_HEATMAP_COLS * CYPRESS_TOUCH_HEATMAP_ROWS;
+    int i = 0;
+    while (i < _total)
+    {
+        if (_src[i] != 0)
+        {
+            if (_n + 1 > _len) return 0;
+            _buffer[_n++] = _src[i++];
+        }
+        else
+        {
+            // Count the zero cells (max. 255 in one run).
+            uint8_t _run = 0;
+            while (i < _total && _src[i] == 0 && _run < 255)
+            {
+                _run++;
+                i++;
+            }
+
+            if (_n + 2 > _len) return 0;
+            _buffer[_n++] = 0;
+            _buffer[_n++] = _run;
+        }
+    }
+
+    return _n;
+}
+
+/**
+ * @brief       Get accumulator stats. Average cost per report is totalCycles / reports.
+ * 
+ * @param       struct cypressTouchHeatmapStats *_stats
+ *              Defined in cypressTouchTypedefs.h, pointer to the struct where stats will be copied.
+ */
+void CypressTouchHeatmap::getStats(struct cypressTouchHeatmapStats *_stats)
+{
+    // Check for the null-pointer trap.
+    if (_stats == NULL) return;
+
+    memcpy(_stats, &this->_stats, sizeof(this->_stats));
+}
+
+/**
+ * @brief       Add one contact to the selected context (if it's new, has moved into other cell or the
+ *              dwell interval has passed).
+ * 
+ * @param       uint8_t _channel
+ *              Contact index in the touch report (0 or 1).
+ * @param       uint16_t _x
+ *              Raw X position of the contact.
+ * @param       uint16_t _y
+ *              Raw Y position of the contact.
+ */
+void CypressTouchHeatmap::addPoint(uint8_t _channel, uint16_t _x, uint16_t _y)
+{
+    // Clamp position to the touch range (controller can report a bit outside of it).
+    if (_x > CYPRESS_TOUCH_MAX_X) _x = CYPRESS_TOUCH_MAX_X;
+    if (_y > CYPRESS_TOUCH_MAX_Y) _y = CYPRESS_TOUCH_MAX_Y;
+
+    // Get the cell index.
+    uint32_t _col = ((uint32_t)_x * _scaleX) >> 16;
+    uint32_t _row = ((uint32_t)_y * _scaleY) >> 16;
+    uint16_t _index = _row * CYPRESS_TOUCH_HEATMAP_COLS + _col;
+
+    _stats.samples++;
+
+    // Still in the same cell and dwell interval has not passed yet? Already counted.
+    unsigned long _now = millis();
+    if (_index == _lastCell[_channel] && (_now - _lastCount[_channel]) < CYPRESS_TOUCH_HEATMAP_DWELL_MS) return;
+    _lastCell[_channel] = _index;
+    _lastCount[_channel] = _now;
+
+    // Saturating increment.
+    uint8_t *_cell = &_cells[_context][_row][_col];
+    if (*_cell < 255)
+    {
+        (*_cell)++;
+    }
+    else
+    {
+        _stats.saturated++;
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef __CYPRESSTOUCHHEATMAP_H__
+#define __CYPRESSTOUCHHEATMAP_H__
+
+// Include main Arduino header file.
+#include <Arduino.h>
+
+// Include main Cypress touch library header.
+#include "cypressTouch.h"
+
+// Size of the heatmap grid (over the whole CYPRESS_TOUCH_MAX_X x CYPRESS_TOUCH_MAX_Y touch range).
+// Each cell is one byte, so one context uses COLS * ROWS bytes of RAM.
+#define CYPRESS_TOUCH_HEATMAP_COLS      64
+#define CYPRESS_TOUCH_HEATMAP_ROWS      48
+
+// Number of the heatmap contexts (for example one for each application screen).
+#define CYPRESS_TOUCH_HEATMAP_CONTEXTS  4
+
+// Contact is counted when it touches down or moves into other cell and once more for each DWELL_MS it
+// stays in the same cell (not for each report), so a long press doesn't fill the cell in seconds.
+#define CYPRESS_TOUCH_HEATMAP_DWELL_MS  500
+
+// No cell (contact is lifted).
+#define CYPRESS_TOUCH_HEATMAP_NO_CELL   0xFFFF
+
+// Max. size of the exported heatmap: header + worst case, zero and non-zero cells alternate (each
+// single zero cell takes two bytes, so two cells take three bytes).
+#define CYPRESS_TOUCH_HEATMAP_EXPORT_MAX    (2 + (CYPRESS_TOUCH_HEATMAP_COLS * CYPRESS_TOUCH_HEATMAP_ROWS * 3 + 1) / 2)
+
+class CypressTouchHeatmap
+{
+    public:
+        // Library constructor.
+        CypressTouchHeatmap();
+
+        // Select context that receives new touches.
+        bool setContext(uint8_t _context);
+
+        // Get currently selected context.
+        uint8_t getContext();
+
+        // Add all contacts of the touch report to the selected context.
+        void addReport(struct cypressTouchData *_touchData);
+
+        // Get value of one heatmap cell.
+        uint8_t getCell(uint8_t _context, uint8_t _col, uint8_t _row);
+
+        // Clear one context.
+        bool clear(uint8_t _context);
+
+        // Clear all contexts and stats.
+        void clearAll();
+
+        // Export one context in compact (zero run-length encoded) format.
+        size_t exportContext(uint8_t _context, uint8_t *_buffer, size_t _len);
+
+        // Get accumulator stats (number of samples and cost per report).
+        void getStats(struct cypressTouchHeatmapStats *_stats);
+
+    private:
+        // Heatmap counters of all contexts.
+        uint8_t _cells[CYPRESS_TOUCH_HEATMAP_CONTEXTS][CYPRESS_TOUCH_HEATMAP_ROWS][CYPRESS_TOUCH_HEATMAP_COLS];
+
+        // Touch position to cell index scale (Q16), so binning needs only multiply and shift.
+        uint32_t _scaleX = 0;
+        uint32_t _scaleY = 0;
+
+        // Selected context.
+        volatile uint8_t _context = 0;
+
+        // Accumulator stats.
+        struct cypressTouchHeatmapStats _stats;
+
+        // Cell of each contact in the last report and when it was counted last time.
+        uint16_t _lastCell[2];
+        unsigned long _lastCount[2];
+
+        // Add one contact to the selected context.
+        void addPoint(uint8_t _channel, uint16_t _x, uint16_t _y);
+};
+
+#endif
@@ -0,0 +1,324 @@
+// Include main header file of the touch position predictor.
+#include "cypressTouchPredictor.h"
+
+/**
+ * @brief Constructor for a new CypressTouchPredictor object.
+ * 
+ */
+CypressTouchPredictor::CypressTouchPredictor()
+{
+    reset();
+}
+
+/**
+ * @brief       Set how far ahead contact position is predicted. It should be close to the total
+ *              latency (scan interval + I2C read + display refresh).
+ * 
+ * @param       uint16_t _ms
+ *              Prediction time in milliseconds (max. CYPRESS_TOUCH_PREDICT_MAX_MS).
+ */
+void CypressTouchPredictor::setLookahead(uint16_t _ms)
+{
+    _lookahead = _ms > CYPRESS_TOUCH_PREDICT_MAX_MS ? CYPRESS_TOUCH_PREDICT_MAX_MS : _ms;
+}
+
+/**
+ * @brief       Clear history of all contacts.
+ * 
+ */
+void CypressTouchPredictor::reset()
+{
+    memset(_contacts, 0, sizeof(_contacts));
+    memset(&_lastReport, 0, sizeof(_lastReport));
+}
+
+/**
+ * @brief       Add new touch report to the contact history. Call it for every report read
+ *              with getTouchData() (before scale()).
+ * 
+ * @param       struct cypressTouchData *_touchData
+ *              Defined in cypressTouchTypedefs.h, touch report.
+ * @param       uint32_t _timestamp
+ *              Time when the report was read in milliseconds (for example millis()).
+ */
+void CypressTouchPredictor::update(struct cypressTouchData *_touchData, uint32_t _timestamp)
+{
+    // Check for the null-pointer trap.
+    if (_touchData == NULL) return;
+
+    // Save the report.
+    memcpy(&_lastReport, _touchData, sizeof(struct cypressTouchData));
+
+    // Update each channel. Channel without finger loses its history.
+    for (int i = 0; i < 2; i++)
+    {
+        if (i < _touchData->fingers)
+        {
+            updateContact(&_contacts[i], _touchData->x[i], _touchData->y[i], _timestamp);
+        }
+        else
+        {
+            memset(&_contacts[i], 0, sizeof(struct cypressTouchContactState));
+        }
+    }
+}
+
+/**
+ * @brief       Get predicted position of each contact. Z value, number of fingers and detection
+ *              type are copied from the last report.
+ * 
+ * @param       struct cypressTouchData *_predicted
+ *              Defined in cypressTouchTypedefs.h, predicted report will be stored here.
+ * @param       uint8_t *_confidence
+ *              Array of two elements for the confidence of each contact (0 - no confidence,
+ *              255 - full confidence). Can be NULL.
+ * 
+ * @return      bool
+ *              true - There is at least one active contact.
+ *              false - No contacts, nothing to predict.
+ */
+bool CypressTouchPredictor::predict(struct cypressTouchData *_predicted, uint8_t *_confidence)
+{
+    // Check for the null-pointer trap.
+    if (_predicted == NULL) return false;
+
+    // Start from the last report.
+    memcpy(_predicted, &_lastReport, sizeof(struct cypressTouchData));
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (_contacts[i].active)
+        {
+            int32_t _x, _y;
+            predictContact(&_contacts[i], _lookahead, &_x, &_y);
+            _predicted->x[i] = _x;
+            _predicted->y[i] = _y;
+        }
+
+        if (_confidence != NULL) _confidence[i] = contactConfidence(&_contacts[i]);
+    }
+
+    return _lastReport.fingers != 0 ? true : false;
+}
+
+/**
+ * @brief       Replay recorded trace and compare predicted position with the position that was
+ *              really reported lookahead milliseconds later (linear interpolation between the
+ *              reports). Error without prediction (just using last reported position) is also
+ *              calculated for the comparison.
+ * 
+ * @param       const struct cypressTouchTracePoint *_trace
+ *              Defined in cypressTouchTypedefs.h, recorded reports of the first touch channel.
+ * @param       int _len
+ *              Number of the reports in the trace.
+ * @param       uint16_t _lookahead
+ *              Prediction time in milliseconds.
+ * @param       struct cypressTouchPredictionError *_result
+ *              Defined in cypressTouchTypedefs.h, result will be stored here.
+ * 
+ * @return      bool
+ *              true - Evaluation done, at least one prediction has been checked.
+ *              false - Bad parameters or trace too short.
+ * 
+ * @note        Trace is replayed on a separate predictor, history and prediction time of this
+ *              one are not changed.
+ */
+bool CypressTouchPredictor::evaluate(const struct cypressTouchTracePoint *_trace, int _len, uint16_t _lookahead, struct cypressTouchPredictionError *_result)
+{
+    // Check for the null-pointer trap.
+    if (_trace == NULL || _result == NULL || _len < 2) return false;
+
+    // Replay the trace on a scratch predictor, so history and prediction time of this one stay
+    // untouched (evaluation can run while the predictor is in use).
+    CypressTouchPredictor _scratch;
+    _scratch.setLookahead(_lookahead);
+
+    // Sum of the errors for the mean value.
+    double _errorSum = 0;
+    double _errorSumNoPrediction = 0;
+    memset(_result, 0, sizeof(struct cypressTouchPredictionError));
+
+    for (int i = 0; i < _len; i++)
+    {
+        // Feed the report into predictor.
+        struct cypressTouchData _report;
+        memset(&_report, 0, sizeof(_report));
+        _report.fingers = _trace[i].fingers ? 1 : 0;
+        _report.x[0] = _trace[i].x;
+        _report.y[0] = _trace[i].y;
+        _scratch.update(&_report, _trace[i].timestamp);
+
+        if (!_report.fingers) continue;
+
+        // Find the first report after the prediction time in the same stroke.
+        uint32_t _target = _trace[i].timestamp + _scratch._lookahead;
+        int j = i + 1;
+        while (j < _len && _trace[j].fingers && _trace[j].timestamp < _target) j++;
+
+        // Stroke ended before the prediction time? Nothing to compare with.
+        if (j >= _len || !_trace[j].fingers) continue;
+
+        // Interpolate the real position at the prediction time.
+        const struct cypressTouchTracePoint *_a = &_trace[j - 1];
+        const struct cypressTouchTracePoint *_b = &_trace[j];
+        float _t = _b->timestamp != _a->timestamp ? (float)(_target - _a->timestamp) / (_b->timestamp - _a->timestamp) : 1.0;
+        float _realX = _a->x + (_b->x - _a->x) * _t;
+        float _realY = _a->y + (_b->y - _a->y) * _t;
+
+        // Get the prediction.
+        struct cypressTouchData _predicted;
+        _scratch.predict(&_predicted, NULL);
+
+        // Calculate the errors.
+        float _error = hypotf(_predicted.x[0] - _realX, _predicted.y[0] - _realY);
+        float _errorNoPrediction = hypotf(_trace[i].x - _realX, _trace[i].y - _realY);
+        _errorSum += _error;
+        _errorSumNoPrediction += _errorNoPrediction;
+        if (_error > _result->maxError) _result->maxError = _error;
+        _result->samples++;
+    }
+
+    // Calculate mean values.
+    if (_result->samples)
+    {
+        _result->meanError = _errorSum / _result->samples;
+        _result->meanErrorNoPrediction = _errorSumNoPrediction / _result->samples;
+    }
+
+    return _result->samples != 0 ? true : false;
+}
+
+/**
+ * @brief       Update history of one contact. Velocity and acceleration are calculated from the
+ *              difference between two reports and smoothed. History is cleared if the contact
+ *              changes direction or if there is too much time between two reports.
+ * 
+ * @param       struct cypressTouchContactState *_contact
+ *              Contact history.
+ * @param       int32_t _x
+ *              Reported X position.
+ * @param       int32_t _y
+ *              Reported Y position.
+ * @param       uint32_t _timestamp
+ *              Time of the report in milliseconds.
+ */
+void CypressTouchPredictor::updateContact(struct cypressTouchContactState *_contact, int32_t _x, int32_t _y, uint32_t _timestamp)
+{
+    // Time from the last report.
+    int32_t _dt = _timestamp - _contact->timestamp;
+
+    // New contact or history too old? Start from this report.
+    if (!_contact->active || _dt > CYPRESS_TOUCH_PREDICT_GAP_MS || _dt < 0)
+    {
+        memset(_contact, 0, sizeof(struct cypressTouchContactState));
+        _contact->active = true;
+        _contact->samples = 1;
+        _contact->x = _x;
+        _contact->y = _y;
+        _contact->timestamp = _timestamp;
+        return;
+    }
+
+    // Two reports in the same millisecond.
+    if (_dt == 0) _dt = 1;
+
+    // Velocity from this and the last report (1/256 units per ms).
+    int32_t _vx = ((_x - _contact->x) * 256) / _dt;
+    int32_t _vy = ((_y - _contact->y) * 256) / _dt;
+
+    if (_contact->samples == 1)
+    {
+        // Second report, there is only velocity.
+        _contact->vx = _vx;
+        _contact->vy = _vy;
+    }
+    else if (((int64_t)_vx * _contact->vx + (int64_t)_vy * _contact->vy) < 0)
+    {
+        // Direction changed, old velocity and acceleration are not valid anymore.
+        _contact->vx = _vx;
+        _contact->vy = _vy;
+        _contact->ax = 0;
+        _contact->ay = 0;
+        _contact->residual = 0;
+        _contact->samples = 1;
+    }
+    else
+    {
+        // Acceleration from the velocity change (1/65536 units per ms^2).
+        int32_t _ax = ((_vx - _contact->vx) * 256) / _dt;
+        int32_t _ay = ((_vy - _contact->vy) * 256) / _dt;
+
+        // How much new velocity differs from the estimate, used for the confidence.
+        int32_t _residual = abs(_vx - _contact->vx) + abs(_vy - _contact->vy);
+        _contact->residual += (_residual - _contact->residual) / 2;
+
+        // Smooth velocity (1/2) and acceleration (1/4).
+        _contact->vx += (_vx - _contact->vx) / 2;
+        _contact->vy += (_vy - _contact->vy) / 2;
+        _contact->ax += (_ax - _contact->ax) / 4;
+        _contact->ay += (_ay - _contact->ay) / 4;
+    }
+
+    // Save the report.
+    _contact->x = _x;
+    _contact->y = _y;
+    _contact->timestamp = _timestamp;
+    if (_contact->samples < 255) _contact->samples++;
+}
+
+/**
+ * @brief       Calculate predicted position of one contact: p + v * t + a * t^2 / 2.
+ * 
+ * @param       struct cypressTouchContactState *_contact
+ *              Contact history.
+ * @param       uint16_t _ms
+ *              Prediction time in milliseconds.
+ * @param       int32_t *_x
+ *              Predicted X position will be stored here.
+ * @param       int32_t *_y
+ *              Predicted Y position will be stored here.
+ */
+void CypressTouchPredictor::predictContact(struct cypressTouchContactState *_contact, uint16_t _ms, int32_t *_x, int32_t *_y)
+{
+    int64_t _t = _ms;
+
+    // Only one report? Position can't be predicted.
+    if (_contact->samples < 2)
+    {
+        *_x = _contact->x;
+        *_y = _contact->y;
+        return;
+    }
+
+    // Velocity and acceleration parts.
+    int64_t _px = ((int64_t)_contact->x << 16) + (((int64_t)_contact->vx * _t) << 8) + (((int64_t)_contact->ax * _t * _t) >> 1);
+    int64_t _py = ((int64_t)_contact->y << 16) + (((int64_t)_contact->vy * _t) << 8) + (((int64_t)_contact->ay * _t * _t) >> 1);
+
+    // Back to the touch controller units and keep it inside the touchscreen.
+    *_x = constrain((int32_t)(_px >> 16), (int32_t)0, (int32_t)CYPRESS_TOUCH_MAX_X);
+    *_y = constrain((int32_t)(_py >> 16), (int32_t)0, (int32_t)CYPRESS_TOUCH_MAX_Y);
+}
+
+/**
+ * @brief       Calculate the confidence of one contact. It grows with the number of reports and
+ *              drops if the velocity changes a lot between reports.
+ * 
+ * @param       struct cypressTouchContactState *_contact
+ *              Contact history.
+ * 
+ * @return      uint8_t
+ *              Confidence (0 - no confidence, 255 - full confidence).
+ */
+uint8_t CypressTouchPredictor::contactConfidence(struct cypressTouchContactState *_contact)
+{
+    if (!_contact->active || _contact->samples < 2) return 0;
+
+    // Confidence from the number of reports.
+    int32_t _samples = _contact->samples - 1;
+    if (_samples > CYPRESS_TOUCH_PREDICT_MIN_SAMPLES) _samples = CYPRESS_TOUCH_PREDICT_MIN_SAMPLES;
+    int32_t _confidence = (_samples * 255) / CYPRESS_TOUCH_PREDICT_MIN_SAMPLES;
+
+    // Scale it down with the velocity residual (relative to the speed, 1 unit/ms is added for slow moves).
+    int32_t _speed = abs(_contact->vx) + abs(_contact->vy) + 256;
+    return (_confidence * _speed) / (_speed + _contact->residual);
+}
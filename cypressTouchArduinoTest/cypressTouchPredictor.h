@@ -0,0 +1,78 @@
+#ifndef __CYPRESSTOUCHPREDICTOR_H__
+#define __CYPRESSTOUCHPREDICTOR_H__
+
+// Include main Arduino header file.
+#include <Arduino.h>
+
+// Include main Cypress touch library header.
+#include "cypressTouch.h"
+
+// Default prediction time (how far ahead contact position is predicted, in ms).
+#define CYPRESS_TOUCH_PREDICT_DFLT_MS       30
+
+// Max. prediction time in ms.
+#define CYPRESS_TOUCH_PREDICT_MAX_MS        100
+
+// Time between two reports after which contact history is not used anymore (in ms).
+#define CYPRESS_TOUCH_PREDICT_GAP_MS        50
+
+// Number of reports needed for the full confidence.
+#define CYPRESS_TOUCH_PREDICT_MIN_SAMPLES   4
+
+class CypressTouchPredictor
+{
+    public:
+        // Library constructor.
+        CypressTouchPredictor();
+
+        // Set how far ahead position is predicted (in ms).
+        void setLookahead(uint16_t _ms);
+
+        // Clear history of all contacts.
+        void reset();
+
+        // Add new touch report to the contact history.
+        void update(struct cypressTouchData *_touchData, uint32_t _timestamp);
+
+        // Get predicted position of each contact.
+        bool predict(struct cypressTouchData *_predicted, uint8_t *_confidence);
+
+        // Replay recorded trace and calculate prediction error.
+        bool evaluate(const struct cypressTouchTracePoint *_trace, int _len, uint16_t _lookahead, struct cypressTouchPredictionError *_result);
+
+    private:
+        // Contact history. Velocity is in 1/256 units per ms, acceleration in 1/65536 units per ms^2.
+        struct cypressTouchContactState
+        {
+            bool active;
+            uint8_t samples;
+            int32_t x;
+            int32_t y;
+            int32_t vx;
+            int32_t vy;
+            int32_t ax;
+            int32_t ay;
+            int32_t residual;
+            uint32_t timestamp;
+        };
+
+        // State of both touch channels.
+        struct cypressTouchContactState _contacts[2];
+
+        // Original report from the last update (needed for fingers and Z values).
+        struct cypressTouchData _lastReport;
+
+        // Prediction time in ms.
+        uint16_t _lookahead = CYPRESS_TOUCH_PREDICT_DFLT_MS;
+
+        // Update history of one contact.
+        void updateContact(struct cypressTouchContactState *_contact, int32_t _x, int32_t _y, uint32_t _timestamp);
+
+        // Calculate predicted position of one contact.
+        void predictContact(struct cypressTouchContactState *_contact, uint16_t _ms, int32_t *_x, int32_t *_y);
+
+        // Calculate confidence of one contact.
+        uint8_t contactConfidence(struct cypressTouchContactState *_contact);
+};
+
+#endif
@@ -0,0 +1,247 @@
+// Include main header file of the touch pressure model.
+#include "cypressTouchPressure.h"
+
+/**
+ * @brief Constructor for a new CypressTouchPressure object.
+ * 
+ */
+CypressTouchPressure::CypressTouchPressure()
+{
+    setCurve((float)CYPRESS_TOUCH_PRESSURE_DFLT_GAMMA);
+    reset();
+}
+
+/**
+ * @brief       Build response curve lookup table from the gamma value (output = input ^ gamma). It uses
+ *              floating point math, so call it only when configuration changes, not for each report.
+ * 
+ * @param       float _gamma
+ *              Curve gamma (1.0 - linear, < 1.0 - light touches are stronger, > 1.0 - light touches
+ *              are weaker).
+ * 
+ * @return      bool
+ *              true - Lookup table is built.
+ *              false - Gamma is not positive.
+ */
+bool CypressTouchPressure::setCurve(float _gamma)
+{
+    if (!(_gamma > 0)) return false;
+
+    for (int i = 0; i < CYPRESS_TOUCH_PRESSURE_LUT_SIZE; i++)
+    {
+        float _out = 255.0 * powf(i / 255.0, _gamma);
+        _lut[i] = (uint8_t)(_out + 0.5);
+    }
+
+    return true;
+}
+
+/**
+ * @brief       Use custom response curve lookup table (for example measured for the specific pen or panel).
+ * 
+ * @param       const uint8_t *_lut
+ *              Table with CYPRESS_TOUCH_PRESSURE_LUT_SIZE entries, index is normalised Z and value is
+ *              output pressure. Table is copied.
+ * 
+ * @return      bool
+ *              true - Lookup table is set.
+ *              false - Null-pointer.
+ */
+bool CypressTouchPressure::setCurve(const uint8_t *_lut)
+{
+    // Check for the null-pointer trap.
+    if (_lut == NULL) return false;
+
+    memcpy(this->_lut, _lut, sizeof(this->_lut));
+
+    return true;
+}
+
+/**
+ * @brief       Set EWMA smoothing factor of the pressure.
+ * 
+ * @param       uint16_t _alpha
+ *              Weight of the new sample in 1/256 (1 - 256, 256 is no smoothing).
+ * 
+ * @return      bool
+ *              true - Smoothing factor is set.
+ *              false - Value is out of range.
+ */
+bool CypressTouchPressure::setSmoothing(uint16_t _alpha)
+{
+    if (_alpha == 0 || _alpha > 256) return false;
+
+    this->_alpha = _alpha;
+
+    return true;
+}
+
+/**
+ * @brief       Set light touch / hover thresholds. Contact is accepted when its pressure reaches _on and
+ *              it's suppressed again when pressure drops below _off (hysteresis, so the contact doesn't
+ *              flicker near the threshold).
+ * 
+ * @param       uint8_t _on
+ *              Output pressure needed to accept the contact (0 - every contact is accepted).
+ * @param       uint8_t _off
+ *              Output pressure below which contact is suppressed (must not be higher than _on).
+ * 
+ * @return      bool
+ *              true - Thresholds are set.
+ *              false - _off is higher than _on.
+ */
+bool CypressTouchPressure::setThresholds(uint8_t _on, uint8_t _off)
+{
+    if (_off > _on) return false;
+
+    _onThreshold = _on;
+    _offThreshold = _off;
+
+    return true;
+}
+
+/**
+ * @brief       Forget learned raw Z range and contact history.
+ * 
+ */
+void CypressTouchPressure::reset()
+{
+    for (int i = 0; i < 2; i++)
+    {
+        _channels[i].present = false;
+        _channels[i].active = false;
+        _channels[i].zMin = (int32_t)CYPRESS_TOUCH_PRESSURE_DFLT_Z_MIN << 8;
+        _channels[i].zMax = (int32_t)CYPRESS_TOUCH_PRESSURE_DFLT_Z_MAX << 8;
+        _channels[i].smoothed = 0;
+    }
+}
+
+/**
+ * @brief       Get learned raw Z range of one touch channel.
+ * 
+ * @param       uint8_t _channel
+ *              Touch channel (0 or 1).
+ * @param       uint8_t *_zMin
+ *              Learned raw Z of the lightest touch.
+ * @param       uint8_t *_zMax
+ *              Learned raw Z of the strongest touch.
+ */
+void CypressTouchPressure::getRange(uint8_t _channel, uint8_t *_zMin, uint8_t *_zMax)
+{
+    // Check for the null-pointer trap.
+    if (_channel > 1 || _zMin == NULL || _zMax == NULL) return;
+
+    *_zMin = _channels[_channel].zMin >> 8;
+    *_zMax = _channels[_channel].zMax >> 8;
+}
+
+/**
+ * @brief       Calculate normalised pressure of each contact and suppress hovering (too light) contacts.
+ *              Call it for every report read with getTouchData(). It uses only integer math and the
+ *              lookup table, so it's cheap enough for every report (for example for the pressure
+ *              dependent stroke width).
+ * 
+ * @param       struct cypressTouchData *_touchData
+ *              Defined in cypressTouchTypedefs.h, touch report (raw or scaled).
+ * @param       struct cypressTouchPressureData *_pressureData
+ *              Defined in cypressTouchTypedefs.h, report with the normalised pressure of each accepted
+ *              contact (in the first fingers slots, like in the touch report).
+ * 
+ * @return      bool
+ *              true - There is at least one accepted contact.
+ *              false - No contacts, all contacts are hovering or null-pointer.
+ */
+bool CypressTouchPressure::process(struct cypressTouchData *_touchData, struct cypressTouchPressureData *_pressureData)
+{
+    // Check for the null-pointer trap.
+    if (_touchData == NULL || _pressureData == NULL) return false;
+
+    memset(_pressureData, 0, sizeof(struct cypressTouchPressureData));
+
+    for (int i = 0; i < 2; i++)
+    {
+        // Contact is lifted, next one on this channel starts from scratch.
+        if (_touchData->fingers <= i)
+        {
+            _channels[i].present = false;
+            _channels[i].active = false;
+            continue;
+        }
+
+        uint8_t _pressure = updateChannel(&_channels[i], _touchData->z[i]);
+
+        // Hovering contact is not reported, accepted ones are packed into the first slots.
+        if (_channels[i].active)
+        {
+            uint8_t _slot = _pressureData->fingers++;
+            _pressureData->x[_slot] = _touchData->x[i];
+            _pressureData->y[_slot] = _touchData->y[i];
+            _pressureData->pressure[_slot] = _pressure;
+            _pressureData->active |= 1 << i;
+        }
+    }
+
+    return _pressureData->fingers != 0 ? true : false;
+}
+
+/**
+ * @brief       Update one channel (range, smoothing, hysteresis) and get its pressure.
+ * 
+ * @param       struct cypressTouchPressureState *_channel
+ *              Touch channel state.
+ * @param       uint8_t _z
+ *              Raw Z value of the contact.
+ * 
+ * @return      uint8_t
+ *              Output pressure (0 - 255).
+ */
+uint8_t CypressTouchPressure::updateChannel(struct cypressTouchPressureState *_channel, uint8_t _z)
+{
+    // All values are in 1/256 units, so learned range can follow the panel slowly.
+    int32_t _zq = (int32_t)_z << 8;
+
+    // Extend the range right away, shrink it back slowly.
+    if (_zq < _channel->zMin)
+    {
+        _channel->zMin = _zq;
+    }
+    else
+    {
+        _channel->zMin += (_zq - _channel->zMin) >> CYPRESS_TOUCH_PRESSURE_ADAPT_SHIFT;
+    }
+
+    if (_zq > _channel->zMax)
+    {
+        _channel->zMax = _zq;
+    }
+    else
+    {
+        _channel->zMax -= (_channel->zMax - _zq) >> CYPRESS_TOUCH_PRESSURE_ADAPT_SHIFT;
+    }
+
+    // Normalise Z into 0 - 255.
+    int32_t _span = _channel->zMax - _channel->zMin;
+    if (_span < (CYPRESS_TOUCH_PRESSURE_MIN_SPAN << 8)) _span = CYPRESS_TOUCH_PRESSURE_MIN_SPAN << 8;
+    int32_t _norm = ((_zq - _channel->zMin) * 255) / _span;
+    if (_norm > 255) _norm = 255;
+
+    // Smooth it (first sample of the contact is used as it is).
+    if (!_channel->present)
+    {
+        _channel->smoothed = _norm << 8;
+        _channel->present = true;
+    }
+    else
+    {
+        _channel->smoothed += (((_norm << 8) - _channel->smoothed) * (int32_t)_alpha) >> 8;
+    }
+
+    // Apply the response curve.
+    uint8_t _pressure = _lut[_channel->smoothed >> 8];
+
+    // Accept or suppress the contact (with hysteresis).
+    if (!_channel->active && _pressure >= _onThreshold) _channel->active = true;
+    if (_channel->active && _pressure < _offThreshold) _channel->active = false;
+
+    return _pressure;
+}
@@ -0,0 +1,89 @@
+#ifndef __CYPRESSTOUCHPRESSURE_H__
+#define __CYPRESSTOUCHPRESSURE_H__
+
+// Include main Arduino header file.
+#include <Arduino.h>
+
+// Include main Cypress touch library header.
+#include "cypressTouch.h"
+
+// Size of the pressure response curve lookup table (one entry for each normalised Z value).
+#define CYPRESS_TOUCH_PRESSURE_LUT_SIZE     256
+
+// Default response curve (output = input ^ gamma, gamma < 1 makes light touches stronger).
+#define CYPRESS_TOUCH_PRESSURE_DFLT_GAMMA   0.7
+
+// Default EWMA smoothing factor (1 - 256, 256 is no smoothing, lower is smoother).
+#define CYPRESS_TOUCH_PRESSURE_DFLT_ALPHA   96
+
+// Default thresholds of the normalised pressure (0 - 255). Contact is accepted when pressure goes above
+// TOUCH_ON and it's suppressed (hover) when pressure goes below TOUCH_OFF.
+#define CYPRESS_TOUCH_PRESSURE_DFLT_ON      40
+#define CYPRESS_TOUCH_PRESSURE_DFLT_OFF     24
+
+// Starting range of the raw Z values (it's adapted to the panel and fingers while it's used).
+#define CYPRESS_TOUCH_PRESSURE_DFLT_Z_MIN   16
+#define CYPRESS_TOUCH_PRESSURE_DFLT_Z_MAX   160
+
+// Min. difference between learned max. and min. raw Z (so light touches are not stretched to full scale).
+#define CYPRESS_TOUCH_PRESSURE_MIN_SPAN     32
+
+// How fast learned range shrinks back (each sample moves the limit by 1 / 2^ADAPT_SHIFT of the distance).
+#define CYPRESS_TOUCH_PRESSURE_ADAPT_SHIFT  12
+
+class CypressTouchPressure
+{
+    public:
+        // Library constructor.
+        CypressTouchPressure();
+
+        // Build response curve lookup table from the gamma value.
+        bool setCurve(float _gamma);
+
+        // Use custom response curve lookup table.
+        bool setCurve(const uint8_t *_lut);
+
+        // Set EWMA smoothing factor.
+        bool setSmoothing(uint16_t _alpha);
+
+        // Set light touch / hover thresholds.
+        bool setThresholds(uint8_t _on, uint8_t _off);
+
+        // Forget learned Z range and contact history.
+        void reset();
+
+        // Get learned raw Z range of one touch channel.
+        void getRange(uint8_t _channel, uint8_t *_zMin, uint8_t *_zMax);
+
+        // Calculate normalised pressure of each contact and suppress hovering contacts.
+        bool process(struct cypressTouchData *_touchData, struct cypressTouchPressureData *_pressureData);
+
+    private:
+        // State of one touch channel.
+        struct cypressTouchPressureState
+        {
+            bool present;
+            bool active;
+            int32_t zMin;
+            int32_t zMax;
+            int32_t smoothed;
+        };
+
+        // State of both touch channels.
+        struct cypressTouchPressureState _channels[2];
+
+        // Response curve lookup table.
+        uint8_t _lut[CYPRESS_TOUCH_PRESSURE_LUT_SIZE];
+
+        // EWMA smoothing factor (Q8).
+        uint16_t _alpha = CYPRESS_TOUCH_PRESSURE_DFLT_ALPHA;
+
+        // Light touch / hover thresholds.
+        uint8_t _onThreshold = CYPRESS_TOUCH_PRESSURE_DFLT_ON;
+        uint8_t _offThreshold = CYPRESS_TOUCH_PRESSURE_DFLT_OFF;
+
+        // Update one channel and get its pressure.
+        uint8_t updateChannel(struct cypressTouchPressureState *_channel, uint8_t _z);
+};
+
+#endif
@@ -0,0 +1,385 @@
+// Include main header file of the touch-driven refresh scheduler.
+#include "cypressTouchRefresh.h"
+
+/**
+ * @brief Constructor for a new CypressTouchRefresh object.
+ * 
+ */
+CypressTouchRefresh::CypressTouchRefresh()
+{
+    memset(_rects, 0, sizeof(_rects));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**
+ * @brief       Initialize refresh scheduler.
+ * 
+ * @param       Inkplate *_display
+ *              Inkplate object pointer (screen is refreshed with it).
+ * @param       uint16_t _period
+ *              Min. time between two screen refreshes in ms. All changes made in that time are
+ *              refreshed together.
+ * 
+ * @return      bool
+ *              true - Initialization ok.
+ *              false - Null-pointer.
+ */
+bool CypressTouchRefresh::begin(Inkplate *_display, uint16_t _period)
+{
+    // Check for the null-pointer trap.
+    if (_display == NULL) return false;
+
+    _displayPtr = _display;
+    this->_period = _period;
+    _count = 0;
+    _lastRefresh = millis();
+
+    return true;
+}
+
+/**
+ * @brief       Set min. time between two screen refreshes.
+ * 
+ * @param       uint16_t _period
+ *              Refresh period in ms (0 - refresh on every tick() if there are changes).
+ */
+void CypressTouchRefresh::setPeriod(uint16_t _period)
+{
+    this->_period = _period;
+}
+
+/**
+ * @brief       Set callback that refreshes one screen region. Inkplate library can only do
+ *              partialUpdate() of the whole screen, so by default all pending changes are refreshed
+ *              with one partialUpdate(). If the callback is set, it's called for each merged dirty
+ *              rectangle instead (for example for the display driver with windowed update).
+ * 
+ * @param       void (*_callback)(const struct cypressTouchRect *_rect, void *_arg)
+ *              Region refresh function (NULL - use partialUpdate()).
+ * @param       void *_arg
+ *              User argument passed to the callback.
+ */
+void CypressTouchRefresh::setRegionCallback(void (*_callback)(const struct cypressTouchRect *_rect, void *_arg), void *_arg)
+{
+    _regionCallback = _callback;
+    _regionArg = _arg;
+}
+
+/**
+ * @brief       Mark region of the screen as changed. Call it every time something is drawn into the
+ *              frame buffer in response to the touch. Region is merged with the overlapping (or very
+ *              close) pending regions. If the list is full, two regions that make the smallest
+ *              additional area are merged together.
+ * 
+ * @param       int16_t _x
+ *              Upper left corner X position in pixels.
+ * @param       int16_t _y
+ *              Upper left corner Y position in pixels.
+ * @param       int16_t _w
+ *              Region width in pixels.
+ * @param       int16_t _h
+ *              Region height in pixels.
+ */
+void CypressTouchRefresh::addRegion(int16_t _x, int16_t _y, int16_t _w, int16_t _h)
+{
+    // Library must be initialized first.
+    if (_displayPtr == NULL) return;
+
+    // Clip the region to the screen.
+    int32_t _x0 = _x < 0 ? 0 : _x;
+    int32_t _y0 = _y < 0 ? 0 : _y;
+    int32_t _x1 = (int32_t)_x + _w;
+    int32_t _y1 = (int32_t)_y + _h;
+    if (_x1 > _displayPtr->width()) _x1 = _displayPtr->width();
+    if (_y1 > _displayPtr->height()) _y1 = _displayPtr->height();
+    if (_x1 <= _x0 || _y1 <= _y0) return;
+
+    struct cypressTouchRect _rect;
+    _rect.x = _x0;
+    _rect.y = _y0;
+    _rect.w = _x1 - _x0;
+    _rect.h = _y1 - _y0;
+
+    portENTER_CRITICAL(&_mux);
+
+    insertRect(&_rect);
+
+    // If the list is full, merge two rectangles with the smallest area increase. Increase is negative
+    // if they overlap, so it's signed.
+    if (_count > CYPRESS_TOUCH_REFRESH_MAX_RECTS)
+    {
+        int _bestA = 0;
+        int _bestB = 1;
+        int64_t _bestGrowth = INT64_MAX;
+        for (int a = 0; a < _count - 1; a++)
+        {
+            for (int b = a + 1; b < _count; b++)
+            {
+                struct cypressTouchRect _merged;
+                unionRect(&_rects[a], &_rects[b], &_merged);
+                int64_t _growth = (int64_t)rectArea(&_merged) - rectArea(&_rects[a]) - rectArea(&_rects[b]);
+                if (_growth < _bestGrowth)
+                {
+                    _bestGrowth = _growth;
+                    _bestA = a;
+                    _bestB = b;
+                }
+            }
+        }
+
+        // Merged rectangle is bigger and can be near other rectangles now, so insert it again.
+        struct cypressTouchRect _merged;
+        unionRect(&_rects[_bestA], &_rects[_bestB], &_merged);
+        removeRect(_bestB);
+        removeRect(_bestA);
+        insertRect(&_merged);
+    }
+
+    portEXIT_CRITICAL(&_mux);
+}
+
+/**
+ * @brief       Mark square region around the touch point as changed (for example for the pen stroke
+ *              or the touch feedback).
+ * 
+ * @param       int16_t _x
+ *              Touch X position in pixels (after scale()).
+ * @param       int16_t _y
+ *              Touch Y position in pixels (after scale()).
+ * @param       uint16_t _radius
+ *              Radius of the changed region in pixels.
+ */
+void CypressTouchRefresh::addTouch(int16_t _x, int16_t _y, uint16_t _radius)
+{
+    addRegion(_x - _radius, _y - _radius, 2 * _radius + 1, 2 * _radius + 1);
+}
+
+/**
+ * @brief       Get number of the pending dirty rectangles.
+ * 
+ * @return      int
+ *              Number of the rectangles waiting for the refresh.
+ */
+int CypressTouchRefresh::getRegionCount()
+{
+    return _count;
+}
+
+/**
+ * @brief       Refresh the screen if there are pending changes and refresh period has elapsed since the
+ *              last refresh. Call it from the loop (or the display task).
+ * 
+ * @return      bool
+ *              true - Screen has been refreshed.
+ *              false - Nothing to refresh yet.
+ */
+bool CypressTouchRefresh::tick()
+{
+    if (_count == 0) return false;
+
+    if ((uint32_t)(millis() - _lastRefresh) < _period) return false;
+
+    return flush();
+}
+
+/**
+ * @brief       Refresh all pending changes now (with partialUpdate() or with the region callback).
+ * 
+ * @return      bool
+ *              true - Screen has been refreshed.
+ *              false - Library is not initialized or there are no changes.
+ */
+bool CypressTouchRefresh::flush()
+{
+    // Library must be initialized first.
+    if (_displayPtr == NULL) return false;
+
+    // Take pending rectangles, so new ones can be added during the refresh.
+    struct cypressTouchRect _pending[CYPRESS_TOUCH_REFRESH_MAX_RECTS];
+    portENTER_CRITICAL(&_mux);
+    int _n = _count;
+    memcpy(_pending, _rects, _n * sizeof(struct cypressTouchRect));
+    _count = 0;
+    portEXIT_CRITICAL(&_mux);
+
+    if (_n == 0) return false;
+
+    // Refresh the screen. partialUpdate() refreshes the whole screen, so that is the refreshed area.
+    uint32_t _area = 0;
+    if (_regionCallback != NULL)
+    {
+        for (int i = 0; i < _n; i++)
+        {
+            _area += rectArea(&_pending[i]);
+            _regionCallback(&_pending[i], _regionArg);
+        }
+    }
+    else
+    {
+        _displayPtr->partialUpdate();
+        _area = (uint32_t)_displayPtr->width() * _displayPtr->height();
+    }
+    _lastRefresh = millis();
+
+    // Update the stats.
+    uint32_t _refreshes = _regionCallback != NULL ? _n : 1;
+    portENTER_CRITICAL(&_mux);
+    _stats.refreshes += _refreshes;
+    _stats.area += _area;
+    _interactionRefreshes += _refreshes;
+    _interactionArea += _area;
+    portEXIT_CRITICAL(&_mux);
+
+    return true;
+}
+
+/**
+ * @brief       Mark the end of one interaction (call it on the finger release). Refresh count and area
+ *              since the previous call are stored as the last interaction stats.
+ * 
+ */
+void CypressTouchRefresh::endInteraction()
+{
+    portENTER_CRITICAL(&_mux);
+    _stats.interactions++;
+    _stats.lastInteractionRefreshes = _interactionRefreshes;
+    _stats.lastInteractionArea = _interactionArea;
+    if (_interactionRefreshes > _stats.maxInteractionRefreshes) _stats.maxInteractionRefreshes = _interactionRefreshes;
+    if (_interactionArea > _stats.maxInteractionArea) _stats.maxInteractionArea = _interactionArea;
+    _interactionRefreshes = 0;
+    _interactionArea = 0;
+    portEXIT_CRITICAL(&_mux);
+}
+
+/**
+ * @brief       Get refresh statistics.
+ * 
+ * @param       struct cypressTouchRefreshStats *_stats
+ *              Defined in cypressTouchTypedefs.h, pointer to the struct where stats will be copied.
+ */
+void CypressTouchRefresh::getStats(struct cypressTouchRefreshStats *_stats)
+{
+    // Check for the null-pointer trap.
+    if (_stats == NULL) return;
+
+    portENTER_CRITICAL(&_mux);
+    memcpy(_stats, &this->_stats, sizeof(this->_stats));
+    portEXIT_CRITICAL(&_mux);
+}
+
+/**
+ * @brief       Clear refresh statistics.
+ * 
+ */
+void CypressTouchRefresh::clearStats()
+{
+    portENTER_CRITICAL(&_mux);
+    memset(&_stats, 0, sizeof(_stats));
+    _interactionRefreshes = 0;
+    _interactionArea = 0;
+    portEXIT_CRITICAL(&_mux);
+}
+
+/**
+ * @brief       Merge rectangle with all pending rectangles it touches and add it to the end of the
+ *              list. Merged rectangle can touch new ones, so the check starts again after each merge.
+ *              List must be locked and there must be a free slot.
+ * 
+ * @param       struct cypressTouchRect *_rect
+ *              New rectangle, it's grown by the merged ones.
+ */
+void CypressTouchRefresh::insertRect(struct cypressTouchRect *_rect)
+{
+    int i = 0;
+    while (i < _count)
+    {
+        if (isNear(_rect, &_rects[i]))
+        {
+            unionRect(_rect, &_rects[i], _rect);
+            removeRect(i);
+            i = 0;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    _rects[_count++] = *_rect;
+}
+
+/**
+ * @brief       Check if two rectangles overlap or are closer than CYPRESS_TOUCH_REFRESH_MERGE_GAP.
+ * 
+ * @param       const struct cypressTouchRect *_a
+ *              First rectangle.
+ * @param       const struct cypressTouchRect *_b
+ *              Second rectangle.
+ * 
+ * @return      bool
+ *              true - Rectangles should be merged.
+ *              false - Rectangles are far apart.
+ */
+bool CypressTouchRefresh::isNear(const struct cypressTouchRect *_a, const struct cypressTouchRect *_b)
+{
+    int32_t _gap = CYPRESS_TOUCH_REFRESH_MERGE_GAP;
+
+    if ((int32_t)_a->x > (int32_t)_b->x + _b->w + _gap) return false;
+    if ((int32_t)_b->x > (int32_t)_a->x + _a->w + _gap) return false;
+    if ((int32_t)_a->y > (int32_t)_b->y + _b->h + _gap) return false;
+    if ((int32_t)_b->y > (int32_t)_a->y + _a->h + _gap) return false;
+
+    return true;
+}
+
+/**
+ * @brief       Get the smallest rectangle that contains both rectangles. Result can be one of the inputs.
+ * 
+ * @param       const struct cypressTouchRect *_a
+ *              First rectangle.
+ * @param       const struct cypressTouchRect *_b
+ *              Second rectangle.
+ * @param       struct cypressTouchRect *_result
+ *              Merged rectangle.
+ */
+void CypressTouchRefresh::unionRect(const struct cypressTouchRect *_a, const struct cypressTouchRect *_b, struct cypressTouchRect *_result)
+{
+    int32_t _x0 = _a->x < _b->x ? _a->x : _b->x;
+    int32_t _y0 = _a->y < _b->y ? _a->y : _b->y;
+    int32_t _x1 = (int32_t)_a->x + _a->w > (int32_t)_b->x + _b->w ? (int32_t)_a->x + _a->w : (int32_t)_b->x + _b->w;
+    int32_t _y1 = (int32_t)_a->y + _a->h > (int32_t)_b->y + _b->h ? (int32_t)_a->y + _a->h : (int32_t)_b->y + _b->h;
+
+    _result->x = _x0;
+    _result->y = _y0;
+    _result->w = _x1 - _x0;
+    _result->h = _y1 - _y0;
+}
+
+/**
+ * @brief       Get the area of the rectangle.
+ * 
+ * @param       const struct cypressTouchRect *_rect
+ *              Rectangle.
+ * 
+ * @return      uint32_t
+ *              Area in pixels.
+ */
+uint32_t CypressTouchRefresh::rectArea(const struct cypressTouchRect *_rect)
+{
+    return (uint32_t)_rect->w * _rect->h;
+}
+
+/**
+ * @brief       Remove one rectangle from the list.
+ * 
+ * @param       int _index
+ *              Index of the rectangle.
+ */
+void CypressTouchRefresh::removeRect(int _index)
+{
+    for (int i = _index; i < _count - 1; i++)
+    {
+        _rects[i] = _rects[i + 1];
+    }
+    _count--;
+}
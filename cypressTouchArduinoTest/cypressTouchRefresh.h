@@ -0,0 +1,103 @@
+#ifndef __CYPRESSTOUCHREFRESH_H__
+#define __CYPRESSTOUCHREFRESH_H__
+
+// Include main Arduino header file.
+#include <Arduino.h>
+
+// Include FreeRTOS (regions can be added from the other task).
+#include <freertos/FreeRTOS.h>
+
+// Include main Cypress touch library header.
+#include "cypressTouch.h"
+
+// Max. number of the pending dirty rectangles (if there are more, the closest two are merged).
+#define CYPRESS_TOUCH_REFRESH_MAX_RECTS     8
+
+// Rectangles closer than this (in pixels) are merged into one.
+#define CYPRESS_TOUCH_REFRESH_MERGE_GAP     8
+
+// Default time between two screen refreshes (in ms).
+#define CYPRESS_TOUCH_REFRESH_DFLT_PERIOD   150
+
+class CypressTouchRefresh
+{
+    public:
+        // Library constructor.
+        CypressTouchRefresh();
+
+        // Initialization function.
+        bool begin(Inkplate *_display, uint16_t _period = CYPRESS_TOUCH_REFRESH_DFLT_PERIOD);
+
+        // Set time between two screen refreshes (in ms).
+        void setPeriod(uint16_t _period);
+
+        // Set callback that refreshes one region (used instead of the partialUpdate()).
+        void setRegionCallback(void (*_callback)(const struct cypressTouchRect *_rect, void *_arg), void *_arg = NULL);
+
+        // Mark region of the screen as changed.
+        void addRegion(int16_t _x, int16_t _y, int16_t _w, int16_t _h);
+
+        // Mark region around the touch point as changed.
+        void addTouch(int16_t _x, int16_t _y, uint16_t _radius);
+
+        // Get number of the pending dirty rectangles.
+        int getRegionCount();
+
+        // Refresh the screen if there are changes and refresh period has elapsed.
+        bool tick();
+
+        // Refresh all pending changes now.
+        bool flush();
+
+        // Mark the end of one interaction (finger release) for the stats.
+        void endInteraction();
+
+        // Get refresh statistics.
+        void getStats(struct cypressTouchRefreshStats *_stats);
+
+        // Clear refresh statistics.
+        void clearStats();
+
+    private:
+        // Inkplate library internal object pointer.
+        Inkplate *_displayPtr = NULL;
+
+        // Time between two refreshes and time of the last refresh (in ms).
+        uint16_t _period = CYPRESS_TOUCH_REFRESH_DFLT_PERIOD;
+        uint32_t _lastRefresh = 0;
+
+        // Optional region refresh callback.
+        void (*_regionCallback)(const struct cypressTouchRect *_rect, void *_arg) = NULL;
+        void *_regionArg = NULL;
+
+        // Pending dirty rectangles (one more slot for the new rectangle before merging).
+        struct cypressTouchRect _rects[CYPRESS_TOUCH_REFRESH_MAX_RECTS + 1];
+        int _count = 0;
+
+        // Refresh count and area of the current interaction.
+        uint32_t _interactionRefreshes = 0;
+        uint32_t _interactionArea = 0;
+
+        // Refresh statistics.
+        struct cypressTouchRefreshStats _stats;
+
+        // Spinlock for the rectangle list and stats.
+        portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+        // Merge rectangle with all pending rectangles near it and add it to the list.
+        void insertRect(struct cypressTouchRect *_rect);
+
+        // Check if two rectangles overlap (or are closer than CYPRESS_TOUCH_REFRESH_MERGE_GAP).
+        bool isNear(const struct cypressTouchRect *_a, const struct cypressTouchRect *_b);
+
+        // Get the smallest rectangle that contains both rectangles.
+        void unionRect(const struct cypressTouchRect *_a, const struct cypressTouchRect *_b, struct cypressTouchRect *_result);
+
+        // Get the area of the rectangle.
+        uint32_t rectArea(const struct cypressTouchRect *_rect);
+
+        // Remove one rectangle from the list.
+        void removeRect(int _index);
+};
+
+#endif
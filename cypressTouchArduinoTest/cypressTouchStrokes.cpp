@@ -0,0 +1,351 @@
+// Include main header file of the stroke capture.
+#include "cypressTouchStrokes.h"
+
+// Zig-zag encoding for the signed point deltas (small negative numbers stay small).
+#define ZIGZAG_ENCODE(val)          ((uint32_t)(((val) << 1) ^ ((val) >> 31)))
+
+/**
+ * @brief Constructor for a new CypressTouchStrokes object.
+ * 
+ */
+CypressTouchStrokes::CypressTouchStrokes()
+{
+    clear();
+}
+
+/**
+ * @brief       Set simplification parameters.
+ * 
+ * @param       uint16_t _tolerance
+ *              Max. distance between the reported point and the stored stroke (in touch controller units).
+ * @param       uint16_t _minDistance
+ *              Reported points closer than this to the last reported point are ignored.
+ * 
+ * @note        Every reported point is within _tolerance + _minDistance from the stored stroke
+ *              (within _tolerance if _minDistance is 0).
+ */
+void CypressTouchStrokes::setTolerance(uint16_t _tolerance, uint16_t _minDistance)
+{
+    this->_tolerance = _tolerance;
+    this->_minDistance = _minDistance;
+}
+
+/**
+ * @brief       Add new touch report. Stroke starts when the finger touches the screen and ends
+ *              when the finger is released. Points are simplified as they come, only the points
+ *              needed to keep the stroke inside the tolerance are stored.
+ * 
+ * @param       struct cypressTouchData *_touchData
+ *              Defined in cypressTouchTypedefs.h, touch report (raw or scaled).
+ * 
+ * @return      bool
+ *              true - Report is processed.
+ *              false - Point arena or stroke list is full, clear() must be called.
+ */
+bool CypressTouchStrokes::addReport(struct cypressTouchData *_touchData)
+{
+    // Check for the null-pointer trap.
+    if (_touchData == NULL) return false;
+
+    // Finger released? Finish the stroke.
+    if (_touchData->fingers == 0)
+    {
+        if (_drawing) endStroke();
+        return true;
+    }
+
+    _reportedPoints++;
+
+    struct cypressTouchPoint _point = {_touchData->x[0], _touchData->y[0]};
+
+    return _drawing ? addPoint(&_point) : beginStroke(&_point);
+}
+
+/**
+ * @brief       Clear all strokes. Point arena is reset, nothing is freed.
+ * 
+ */
+void CypressTouchStrokes::clear()
+{
+    _pointCount = 0;
+    _strokeCount = 0;
+    _drawing = false;
+    _windowLen = 0;
+    _reportedPoints = 0;
+}
+
+/**
+ * @brief       Get the number of stored strokes (including the one in progress).
+ * 
+ * @return      int
+ *              Number of strokes.
+ */
+int CypressTouchStrokes::getStrokeCount()
+{
+    return _strokeCount;
+}
+
+/**
+ * @brief       Get the points of the stroke.
+ * 
+ * @param       int _index
+ *              Stroke index (0 to getStrokeCount() - 1).
+ * @param       const struct cypressTouchPoint **_strokePoints
+ *              Pointer to the first stroke point in the arena will be stored here.
+ * @param       uint16_t *_count
+ *              Number of the stroke points will be stored here.
+ * 
+ * @return      bool
+ *              true - Stroke found.
+ *              false - Wrong index.
+ */
+bool CypressTouchStrokes::getStroke(int _index, const struct cypressTouchPoint **_strokePoints, uint16_t *_count)
+{
+    // Check the parameters.
+    if (_index < 0 || _index >= _strokeCount || _strokePoints == NULL || _count == NULL) return false;
+
+    *_strokePoints = &_points[_strokes[_index].first];
+    *_count = _strokes[_index].count;
+
+    return true;
+}
+
+/**
+ * @brief       Get the number of reported and stored points since the last clear().
+ * 
+ * @param       uint32_t *_reported
+ *              Number of the points from the touch reports.
+ * @param       uint32_t *_stored
+ *              Number of the points stored in the arena.
+ */
+void CypressTouchStrokes::getPointCount(uint32_t *_reported, uint32_t *_stored)
+{
+    if (_reported != NULL) *_reported = _reportedPoints;
+    if (_stored != NULL) *_stored = _pointCount;
+}
+
+/**
+ * @brief       Pack all strokes into buffer. Format goes as follows (all numbers are
+ *              variable length - 7 bits per byte, MSB set if more bytes follow):
+ *              [varint] Number of strokes.
+ *              For each stroke:
+ *              [varint] Number of points.
+ *              [varint, varint] X and Y difference from the previous point (zig-zag encoded, first
+ *              point of each stroke is relative to 0, 0).
+ * 
+ * @param       uint8_t *_buffer
+ *              Buffer for the packed strokes.
+ * @param       int _len
+ *              Size of the buffer.
+ * 
+ * @return      int
+ *              Number of bytes written or 0 if the buffer is too small.
+ */
+int CypressTouchStrokes::serialize(uint8_t *_buffer, int _len)
+{
+    // Check for the null-pointer trap.
+    if (_buffer == NULL) return 0;
+
+    int _index = writeVarint(_buffer, 0, _len, _strokeCount);
+
+    for (int i = 0; i < _strokeCount && _index; i++)
+    {
+        _index = writeVarint(_buffer, _index, _len, _strokes[i].count);
+
+        int32_t _lastX = 0;
+        int32_t _lastY = 0;
+        for (int j = 0; j < _strokes[i].count && _index; j++)
+        {
+            struct cypressTouchPoint *_point = &_points[_strokes[i].first + j];
+            int32_t _dx = (int32_t)_point->x - _lastX;
+            int32_t _dy = (int32_t)_point->y - _lastY;
+            _index = writeVarint(_buffer, _index, _len, ZIGZAG_ENCODE(_dx));
+            if (_index) _index = writeVarint(_buffer, _index, _len, ZIGZAG_ENCODE(_dy));
+            _lastX = _point->x;
+            _lastY = _point->y;
+        }
+    }
+
+    return _index;
+}
+
+/**
+ * @brief       Start new stroke. First point is always stored.
+ * 
+ * @param       struct cypressTouchPoint *_point
+ *              First point of the stroke.
+ * 
+ * @return      bool
+ *              true - Stroke started.
+ *              false - Arena or stroke list is full.
+ */
+bool CypressTouchStrokes::beginStroke(struct cypressTouchPoint *_point)
+{
+    // Check if there is space for a new stroke.
+    if (_strokeCount >= CYPRESS_TOUCH_STROKE_MAX_STROKES || _pointCount >= CYPRESS_TOUCH_STROKE_MAX_POINTS) return false;
+
+    _strokes[_strokeCount].first = _pointCount;
+    _strokes[_strokeCount].count = 0;
+    _strokeCount++;
+
+    _drawing = true;
+    _windowLen = 0;
+    _lastReported = *_point;
+
+    return storePoint(_point);
+}
+
+/**
+ * @brief       Add point to the current stroke. Points too close to the last reported point are
+ *              ignored (radial distance). Others are kept in the window while the segment from the
+ *              last stored point to the new point is within the tolerance from all of them. When it's
+ *              not, the previous point is stored and it becomes start of the new segment.
+ * 
+ * @param       struct cypressTouchPoint *_point
+ *              New stroke point.
+ * 
+ * @return      bool
+ *              true - Point is processed.
+ *              false - Arena is full, stroke is cut here.
+ */
+bool CypressTouchStrokes::addPoint(struct cypressTouchPoint *_point)
+{
+    // Radial distance filter.
+    int32_t _dx = (int32_t)_point->x - _lastReported.x;
+    int32_t _dy = (int32_t)_point->y - _lastReported.y;
+    if ((_dx * _dx + _dy * _dy) < ((int32_t)_minDistance * _minDistance)) return true;
+    _lastReported = *_point;
+
+    // Start of the current segment is the last stored point.
+    struct cypressTouchPoint *_start = &_points[_pointCount - 1];
+
+    // Segment is still within the tolerance? Just keep the point as candidate.
+    if (_windowLen < CYPRESS_TOUCH_STROKE_WINDOW && segmentFits(_start, _point))
+    {
+        _window[_windowLen++] = *_point;
+        return true;
+    }
+
+    // Otherwise store the last candidate and start the new segment from it.
+    bool _ret = storePoint(&_window[_windowLen - 1]);
+    _window[0] = *_point;
+    _windowLen = 1;
+
+    // Arena full? Stroke ends here.
+    if (!_ret) _drawing = false;
+
+    return _ret;
+}
+
+/**
+ * @brief       Finish current stroke (last point is always stored).
+ * 
+ */
+void CypressTouchStrokes::endStroke()
+{
+    if (_windowLen) storePoint(&_window[_windowLen - 1]);
+    _windowLen = 0;
+    _drawing = false;
+}
+
+/**
+ * @brief       Store point into arena and add it to the current stroke.
+ * 
+ * @param       struct cypressTouchPoint *_point
+ *              Point that needs to be stored.
+ * 
+ * @return      bool
+ *              true - Point is stored.
+ *              false - Arena is full.
+ */
+bool CypressTouchStrokes::storePoint(struct cypressTouchPoint *_point)
+{
+    if (_pointCount >= CYPRESS_TOUCH_STROKE_MAX_POINTS) return false;
+
+    _points[_pointCount++] = *_point;
+    _strokes[_strokeCount - 1].count++;
+
+    return true;
+}
+
+/**
+ * @brief       Check if all points in the window are close enough to the segment. If the point
+ *              projects inside the segment, distance from the line is |cross(end - start, point - start)|
+ *              / |end - start|, otherwise it's the distance from the nearest end (so the tip of the stroke
+ *              that turns back is not lost). Distances are compared squared, so there is no division
+ *              or square root.
+ * 
+ * @param       struct cypressTouchPoint *_start
+ *              Start of the segment.
+ * @param       struct cypressTouchPoint *_end
+ *              End of the segment.
+ * 
+ * @return      bool
+ *              true - All points are within the tolerance.
+ *              false - At least one point is too far from the segment.
+ */
+bool CypressTouchStrokes::segmentFits(struct cypressTouchPoint *_start, struct cypressTouchPoint *_end)
+{
+    int64_t _sx = (int32_t)_end->x - _start->x;
+    int64_t _sy = (int32_t)_end->y - _start->y;
+    int64_t _segLen = _sx * _sx + _sy * _sy;
+    int64_t _tol = (int64_t)_tolerance * _tolerance;
+
+    for (int i = 0; i < _windowLen; i++)
+    {
+        int64_t _px = (int32_t)_window[i].x - _start->x;
+        int64_t _py = (int32_t)_window[i].y - _start->y;
+
+        // Position of the projection on the segment (0 - start, _segLen - end).
+        int64_t _dot = _sx * _px + _sy * _py;
+
+        if (_dot <= 0)
+        {
+            // Before the start (or start and end are the same point), use the distance from the start.
+            if ((_px * _px + _py * _py) > _tol) return false;
+        }
+        else if (_dot >= _segLen)
+        {
+            // After the end, use the distance from the end.
+            int64_t _ex = _px - _sx;
+            int64_t _ey = _py - _sy;
+            if ((_ex * _ex + _ey * _ey) > _tol) return false;
+        }
+        else
+        {
+            int64_t _cross = _sx * _py - _sy * _px;
+            if ((_cross * _cross) > (_tol * _segLen)) return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief       Write variable length number into buffer (7 bits per byte, LSB first).
+ * 
+ * @param       uint8_t *_buffer
+ *              Output buffer.
+ * @param       int _index
+ *              Buffer index where the number is written.
+ * @param       int _len
+ *              Size of the buffer.
+ * @param       uint32_t _value
+ *              Number that needs to be written.
+ * 
+ * @return      int
+ *              New buffer index or 0 if there is no space left in the buffer.
+ */
+int CypressTouchStrokes::writeVarint(uint8_t *_buffer, int _index, int _len, uint32_t _value)
+{
+    do
+    {
+        if (_index >= _len) return 0;
+
+        uint8_t _byte = _value & 0x7F;
+        _value >>= 7;
+        _buffer[_index++] = _value ? (_byte | 0x80) : _byte;
+    } while (_value);
+
+    return _index;
+}
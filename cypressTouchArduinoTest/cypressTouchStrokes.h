@@ -0,0 +1,91 @@
+#ifndef __CYPRESSTOUCHSTROKES_H__
+#define __CYPRESSTOUCHSTROKES_H__
+
+// Include main Arduino header file.
+#include <Arduino.h>
+
+// Include main Cypress touch library header.
+#include "cypressTouch.h"
+
+// Size of the point arena (for all strokes on one page) and max. number of strokes.
+#define CYPRESS_TOUCH_STROKE_MAX_POINTS     2048
+#define CYPRESS_TOUCH_STROKE_MAX_STROKES    128
+
+// Max. number of not stored points used for the line simplification.
+#define CYPRESS_TOUCH_STROKE_WINDOW         32
+
+// Default simplification tolerance and min. distance between two points (in touch controller units).
+#define CYPRESS_TOUCH_STROKE_DFLT_TOLERANCE 2
+#define CYPRESS_TOUCH_STROKE_DFLT_MIN_DIST  3
+
+class CypressTouchStrokes
+{
+    public:
+        // Library constructor.
+        CypressTouchStrokes();
+
+        // Set simplification parameters.
+        void setTolerance(uint16_t _tolerance, uint16_t _minDistance);
+
+        // Add new touch report (first touch channel is used for the strokes).
+        bool addReport(struct cypressTouchData *_touchData);
+
+        // Clear all strokes (new page).
+        void clear();
+
+        // Get the number of stored strokes.
+        int getStrokeCount();
+
+        // Get the points of the stroke.
+        bool getStroke(int _index, const struct cypressTouchPoint **_strokePoints, uint16_t *_count);
+
+        // Get the number of reported and stored points.
+        void getPointCount(uint32_t *_reported, uint32_t *_stored);
+
+        // Pack all strokes into buffer.
+        int serialize(uint8_t *_buffer, int _len);
+
+    private:
+        // Point arena and strokes.
+        struct cypressTouchPoint _points[CYPRESS_TOUCH_STROKE_MAX_POINTS];
+        struct cypressTouchStroke _strokes[CYPRESS_TOUCH_STROKE_MAX_STROKES];
+        uint16_t _pointCount = 0;
+        uint16_t _strokeCount = 0;
+
+        // Is the stroke in progress?
+        bool _drawing = false;
+
+        // Points that are not stored yet (candidates for the end point of the current segment).
+        struct cypressTouchPoint _window[CYPRESS_TOUCH_STROKE_WINDOW];
+        int _windowLen = 0;
+
+        // Last reported point (for the radial distance filter).
+        struct cypressTouchPoint _lastReported;
+
+        // Simplification parameters.
+        uint16_t _tolerance = CYPRESS_TOUCH_STROKE_DFLT_TOLERANCE;
+        uint16_t _minDistance = CYPRESS_TOUCH_STROKE_DFLT_MIN_DIST;
+
+        // Statistics.
+        uint32_t _reportedPoints = 0;
+
+        // Start new stroke.
+        bool beginStroke(struct cypressTouchPoint *_point);
+
+        // Add point to the current stroke.
+        bool addPoint(struct cypressTouchPoint *_point);
+
+        // Finish current stroke.
+        void endStroke();
+
+        // Store point into arena.
+        bool storePoint(struct cypressTouchPoint *_point);
+
+        // Check if all points in the window are close enough to the segment.
+        bool segmentFits(struct cypressTouchPoint *_start, struct cypressTouchPoint *_end);
+
+        // Write variable length number into buffer.
+        int writeVarint(uint8_t *_buffer, int _index, int _len, uint32_t _value);
+};
+
+#endif
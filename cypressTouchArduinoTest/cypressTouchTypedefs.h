@@ -54,4 +54,114 @@ struct cypressTouchData
 	uint8_t detectionType;
 };
 
+// I2C bus statistics (times are in microseconds).
+struct cypressTouchI2CStats
+{
+	uint32_t clock;
+	uint32_t transfers;
+	uint32_t errors;
+	uint32_t fallbacks;
+	uint32_t lastTransferTime;
+	uint32_t maxTransferTime;
+	uint32_t reportReadTime;
+};
+
+// I2C bus arbiter statistics of one bus client (times are in microseconds).
+struct cypressTouchBusStats
+{
+	uint32_t transactions;
+	uint32_t mergedWrites;
+	uint64_t busyTime;
+	uint64_t waitTime;
+	uint32_t maxWaitTime;
+};
+
+// Small touch event record used for the event dispatch (copied to each subscriber).
+struct cypressTouchEvent
+{
+	uint8_t type;
+	uint8_t fingers;
+	uint16_t x[2];
+	uint16_t y[2];
+	uint8_t z[2];
+	uint32_t timestamp;
+};
+
+// One recorded touch report (single contact) used for the offline prediction evaluation.
+struct cypressTouchTracePoint
+{
+	uint32_t timestamp;
+	uint8_t fingers;
+	uint16_t x;
+	uint16_t y;
+};
+
+// Result of the offline prediction evaluation (errors are in touch controller units).
+struct cypressTouchPredictionError
+{
+	uint32_t samples;
+	float meanError;
+	float maxError;
+	float meanErrorNoPrediction;
+};
+
+// One stored stroke point.
+struct cypressTouchPoint
+{
+	uint16_t x;
+	uint16_t y;
+};
+
+// Stroke data, points are stored in the stroke point arena.
+struct cypressTouchStroke
+{
+	uint16_t first;
+	uint16_t count;
+};
+
+// Heatmap accumulator stats (cost is measured in CPU cycles).
+struct cypressTouchHeatmapStats
+{
+	uint32_t reports;
+	uint32_t samples;
+	uint32_t saturated;
+	uint32_t lastCycles;
+	uint32_t maxCycles;
+	uint64_t totalCycles;
+};
+
+// Screen rectangle (in pixels).
+struct cypressTouchRect
+{
+	int16_t x;
+	int16_t y;
+	int16_t w;
+	int16_t h;
+};
+
+// Screen refresh stats. Area is the refreshed area in pixels (sum of the dirty rectangles with the region
+// callback, whole screen for each partialUpdate()).
+struct cypressTouchRefreshStats
+{
+	uint32_t interactions;
+	uint32_t refreshes;
+	uint64_t area;
+	uint32_t lastInteractionRefreshes;
+	uint32_t lastInteractionArea;
+	uint32_t maxInteractionRefreshes;
+	uint32_t maxInteractionArea;
+};
+
+// Touch report with normalised pressure. Hovering (too light) contacts are suppressed, accepted contacts
+// are in the first fingers slots of x, y and pressure. Bit 0 and bit 1 of active tell if the contact of
+// the first and second touch channel is accepted.
+struct cypressTouchPressureData
+{
+	uint8_t fingers;
+	uint8_t active;
+	uint16_t x[2];
+	uint16_t y[2];
+	uint8_t pressure[2];
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,245 @@
+// Emulated Cypress TTSP Touchscreen Controller for the host tests.
+#include "cypressTouchEmulator.h"
+
+// Default bootloader security keys.
+static const uint8_t _emuKeys[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+CypressTouchEmulator::CypressTouchEmulator()
+{
+    memset(flash, 0xFF, sizeof(flash));
+    memset(written, 0, sizeof(written));
+    memset(_blRegs, 0, sizeof(_blRegs));
+    memset(_opRegs, 0, sizeof(_opRegs));
+    memset(_sysRegs, 0, sizeof(_sysRegs));
+
+    // Bootloader and TTSP versions.
+    _blRegs[3] = 0x01;
+    _blRegs[4] = 0x02;
+    _sysRegs[17] = 0x02;
+    _sysRegs[18] = 0x05;
+}
+
+void CypressTouchEmulator::attach()
+{
+    hostAttachI2C(0x24, this);
+    hostSetIOHook(ioHook, this);
+}
+
+bool CypressTouchEmulator::inBootloader()
+{
+    return _mode == EMU_MODE_BOOTLOADER;
+}
+
+void CypressTouchEmulator::ioHook(uint8_t _pin, uint8_t _state, void *_arg)
+{
+    CypressTouchEmulator *_emu = (CypressTouchEmulator *)_arg;
+
+    if (_pin == EMU_PWR_PIN)
+    {
+        _emu->_powered = _state == HIGH;
+        if (!_emu->_powered) _emu->_mode = EMU_MODE_OFF;
+    }
+    else if (_pin == EMU_RST_PIN)
+    {
+        // Controller starts on the rising edge of the reset line.
+        if (_emu->_rstState == LOW && _state == HIGH && _emu->_powered) _emu->reset();
+        _emu->_rstState = _state;
+    }
+}
+
+void CypressTouchEmulator::reset()
+{
+    resets++;
+    _busy = false;
+    _regPtr = 0;
+    _blRegs[2] = 0;
+    memset(_opRegs, 0, sizeof(_opRegs));
+    _mode = autoLaunchApp ? EMU_MODE_OPERATE : EMU_MODE_BOOTLOADER;
+}
+
+void CypressTouchEmulator::updateBusy()
+{
+    if (_busy && (micros() - _busySince) >= flashTimeUs) _busy = false;
+}
+
+bool CypressTouchEmulator::checkKeys(const uint8_t *_keys)
+{
+    return memcmp(_keys, _emuKeys, sizeof(_emuKeys)) == 0;
+}
+
+bool CypressTouchEmulator::i2cWrite(const uint8_t *_data, size_t _len)
+{
+    updateBusy();
+
+    // Not powered, clock too fast, injected fault or flash write in progress - NACK.
+    if (_mode == EMU_MODE_OFF || hostGetI2CClock() > maxClock || failWrites > 0 || (_busy && (micros() - _busySince) < nackTimeUs))
+    {
+        if (failWrites > 0) failWrites--;
+        nacks++;
+        return false;
+    }
+
+    if (_len == 0) return true;
+
+    // First byte is the register address.
+    _regPtr = _data[0];
+    _data++;
+    _len--;
+    if (_len == 0) return true;
+
+    if (_mode == EMU_MODE_BOOTLOADER)
+    {
+        bootloaderWrite(_data, _len);
+        return true;
+    }
+
+    // Bootloader command in the application (same packet layout as in the bootloader), only enter
+    // bootloader command is executed.
+    if (_regPtr == 0 && _len >= 11 && _data[0] == 0x00 && _data[1] == EMU_BL_CMD)
+    {
+        if (_data[2] == EMU_BL_ENTER && checkKeys(_data + 3)) _mode = EMU_MODE_BOOTLOADER;
+        return true;
+    }
+
+    // Register writes in the application.
+    for (size_t i = 0; i < _len; i++)
+    {
+        uint8_t _reg = _regPtr + i;
+        if (_reg == 0)
+        {
+            // Host mode register (mode is in bits 4 - 6, bit 7 is the handshake).
+            uint8_t _hstMode = _data[i];
+            if (_hstMode & 0x01)
+            {
+                // Soft reset.
+                reset();
+                return true;
+            }
+            _mode = (_hstMode & 0x70) == 0x10 ? EMU_MODE_SYSINFO : EMU_MODE_OPERATE;
+            _opRegs[0] = _hstMode;
+            _sysRegs[0] = _hstMode;
+        }
+        else if (_mode == EMU_MODE_SYSINFO)
+        {
+            if (_reg < sizeof(_sysRegs)) _sysRegs[_reg] = _data[i];
+        }
+        else
+        {
+            if (_reg < sizeof(_opRegs)) _opRegs[_reg] = _data[i];
+        }
+    }
+
+    return true;
+}
+
+void CypressTouchEmulator::bootloaderWrite(const uint8_t *_data, size_t _len)
+{
+    // Packet layout (same as bl_cmd in Linux cyttsp driver): [file offset 0x00][0xFF][command][8 keys]...
+    if (_regPtr != 0 || _len < 11 || _data[0] != 0x00 || _data[1] != EMU_BL_CMD || !checkKeys(_data + 3))
+    {
+        // Short writes (for example soft reset command) are ignored, everything else is a bad packet.
+        if (_len > 1)
+        {
+            _blRegs[2] |= EMU_BL_ERROR_BAD_PKT;
+            rejectedPackets++;
+        }
+        return;
+    }
+
+    uint8_t _cmd = _data[2];
+    _blRegs[2] = 0;
+
+    if (_cmd == EMU_BL_EXIT)
+    {
+        _mode = EMU_MODE_OPERATE;
+        memset(_opRegs, 0, sizeof(_opRegs));
+        return;
+    }
+
+    if (_cmd == EMU_BL_ENTER) return;
+
+    if (_cmd == EMU_BL_WRITE_BLOCK && _len == 11 + 2 + EMU_BLOCK_SIZE + 2)
+    {
+        uint16_t _block = (_data[11] << 8) | _data[12];
+        const uint8_t *_blockData = _data + 13;
+        uint16_t _checksum = (_data[13 + EMU_BLOCK_SIZE] << 8) | _data[14 + EMU_BLOCK_SIZE];
+
+        uint16_t _sum = 0;
+        for (int i = 0; i < EMU_BLOCK_SIZE; i++) _sum += _blockData[i];
+
+        if (_sum != _checksum || _block >= EMU_FLASH_BLOCKS || badChecksums > 0)
+        {
+            if (badChecksums > 0) badChecksums--;
+            _blRegs[2] |= EMU_BL_ERROR_BAD_PKT;
+            rejectedPackets++;
+            return;
+        }
+
+        memcpy(flash[_block], _blockData, EMU_BLOCK_SIZE);
+        written[_block] = true;
+        blockWrites++;
+
+        // Flash write takes some time.
+        _busy = true;
+        _busySince = micros();
+        return;
+    }
+
+    _blRegs[2] |= EMU_BL_ERROR_BAD_PKT;
+    rejectedPackets++;
+}
+
+bool CypressTouchEmulator::i2cRead(uint8_t *_data, size_t _len)
+{
+    updateBusy();
+
+    if (_mode == EMU_MODE_OFF || hostGetI2CClock() > maxClock || (_busy && (micros() - _busySince) < nackTimeUs))
+    {
+        nacks++;
+        return false;
+    }
+
+    const uint8_t *_regs;
+    size_t _size;
+    if (_mode == EMU_MODE_BOOTLOADER)
+    {
+        _blRegs[1] = EMU_BL_STATUS_BLMODE | EMU_BL_STATUS_VALID | (_busy ? EMU_BL_STATUS_BUSY : 0);
+        _regs = _blRegs;
+        _size = sizeof(_blRegs);
+    }
+    else if (_mode == EMU_MODE_SYSINFO)
+    {
+        _regs = _sysRegs;
+        _size = sizeof(_sysRegs);
+    }
+    else
+    {
+        _regs = _opRegs;
+        _size = sizeof(_opRegs);
+    }
+
+    for (size_t i = 0; i < _len; i++)
+    {
+        size_t _reg = _regPtr + i;
+        _data[i] = _reg < _size ? _regs[_reg] : 0;
+    }
+
+    return true;
+}
+
+void CypressTouchEmulator::touch(uint8_t _fingers, uint16_t _x0, uint16_t _y0, uint8_t _z0, uint16_t _x1, uint16_t _y1, uint8_t _z1)
+{
+    _opRegs[2] = _fingers;
+    _opRegs[3] = _x0 >> 8;
+    _opRegs[4] = _x0 & 0xFF;
+    _opRegs[5] = _y0 >> 8;
+    _opRegs[6] = _y0 & 0xFF;
+    _opRegs[7] = _z0;
+    _opRegs[9] = _x1 >> 8;
+    _opRegs[10] = _x1 & 0xFF;
+    _opRegs[11] = _y1 >> 8;
+    _opRegs[12] = _y1 & 0xFF;
+    _opRegs[13] = _z1;
+
+    hostTriggerInterrupt(EMU_INT_PIN);
+}
@@ -0,0 +1,108 @@
+#ifndef __CYPRESSTOUCHEMULATOR_H__
+#define __CYPRESSTOUCHEMULATOR_H__
+
+// Emulated Cypress TTSP Touchscreen Controller for the host tests. It emulates the bootloader
+// (bl_status / bl_error registers, security keys, block checksum check, NACKs while the flash block
+// is written), system info and operating mode (touch reports and the interrupt line).
+#include "hostTest.h"
+#include <Inkplate.h>
+
+// Interrupt pin of the touch controller (same as in the library).
+#define EMU_INT_PIN             36
+
+// I/O expander pins (same as in the library).
+#define EMU_PWR_PIN             IO_PIN_B4
+#define EMU_RST_PIN             IO_PIN_B2
+
+// Bootloader register bits.
+#define EMU_BL_STATUS_BUSY      0x80
+#define EMU_BL_STATUS_BLMODE    0x10
+#define EMU_BL_STATUS_VALID     0x01
+#define EMU_BL_ERROR_BAD_PKT    0x20
+
+// Bootloader commands.
+#define EMU_BL_CMD              0xFF
+#define EMU_BL_ENTER            0x38
+#define EMU_BL_WRITE_BLOCK      0x39
+#define EMU_BL_EXIT             0xA5
+
+// Emulated flash.
+#define EMU_FLASH_BLOCKS        512
+#define EMU_BLOCK_SIZE          64
+
+class CypressTouchEmulator : public HostI2CDevice
+{
+    public:
+        CypressTouchEmulator();
+
+        // Attach emulator to the I2C bus and the I/O expander hook.
+        void attach();
+
+        // I2C device interface.
+        bool i2cWrite(const uint8_t *_data, size_t _len);
+        bool i2cRead(uint8_t *_data, size_t _len);
+
+        // Set new touch report and trigger the interrupt.
+        void touch(uint8_t _fingers, uint16_t _x0, uint16_t _y0, uint8_t _z0, uint16_t _x1 = 0, uint16_t _y1 = 0, uint8_t _z1 = 0);
+
+        // Behaviour options.
+        // Controller starts the application right after the reset (so bootloader must be entered with the command).
+        bool autoLaunchApp = false;
+
+        // Max. working I2C clock (everything is NACKed above it).
+        uint32_t maxClock = 1000000;
+
+        // How long the flash block write takes and for how long controller NACKs in that time (in us).
+        uint32_t flashTimeUs = 6000;
+        uint32_t nackTimeUs = 3000;
+
+        // NACK the next N writes (fault injection).
+        int failWrites = 0;
+
+        // Corrupt the checksum check of the next N block writes (fault injection).
+        int badChecksums = 0;
+
+        // Flash content and which blocks have been written.
+        uint8_t flash[EMU_FLASH_BLOCKS][EMU_BLOCK_SIZE];
+        bool written[EMU_FLASH_BLOCKS];
+
+        // Statistics.
+        uint32_t nacks = 0;
+        uint32_t blockWrites = 0;
+        uint32_t rejectedPackets = 0;
+        uint32_t resets = 0;
+
+        // Current mode.
+        bool inBootloader();
+
+    private:
+        enum emuMode
+        {
+            EMU_MODE_OFF,
+            EMU_MODE_BOOTLOADER,
+            EMU_MODE_OPERATE,
+            EMU_MODE_SYSINFO,
+        };
+
+        enum emuMode _mode = EMU_MODE_OFF;
+        bool _powered = false;
+        uint8_t _rstState = LOW;
+
+        // Register pointer and register files.
+        uint8_t _regPtr = 0;
+        uint8_t _blRegs[16];
+        uint8_t _opRegs[32];
+        uint8_t _sysRegs[32];
+
+        // Time when the flash write has started (0 - not busy).
+        uint64_t _busySince = 0;
+        bool _busy = false;
+
+        static void ioHook(uint8_t _pin, uint8_t _state, void *_arg);
+        void reset();
+        void updateBusy();
+        bool checkKeys(const uint8_t *_keys);
+        void bootloaderWrite(const uint8_t *_data, size_t _len);
+};
+
+#endif
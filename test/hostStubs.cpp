@@ -0,0 +1,661 @@
+// Host implementation of the Arduino, Wire, Inkplate, Preferences and FreeRTOS replacements.
+#include <stdarg.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "hostTest.h"
+#include <Wire.h>
+#include <Inkplate.h>
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <freertos/event_groups.h>
+
+int hostFailures = 0;
+
+HardwareSerial Serial;
+EspClass ESP;
+TwoWire Wire;
+
+// Virtual time in microseconds.
+static uint64_t _hostTime = 0;
+
+// Emulated I2C devices and current I2C clock.
+static HostI2CDevice *_hostDevices[128];
+static uint32_t _hostClock = 100000;
+
+// I/O expander hook.
+static void (*_hostIOHook)(uint8_t _pin, uint8_t _state, void *_arg) = NULL;
+static void *_hostIOArg = NULL;
+
+// delay() hook.
+static void (*_hostDelayHook)(void *_arg) = NULL;
+static void *_hostDelayArg = NULL;
+
+// Attached interrupts.
+static void (*_hostIsr[64])() = {NULL};
+
+// Inkplate partial update counter.
+static uint32_t _hostPartialUpdates = 0;
+
+// Preferences storage.
+static std::map<std::string, std::vector<uint8_t>> _hostPrefs;
+
+// ---------------------------------------------------------------------------------------------
+// Test helpers.
+
+void hostAttachI2C(uint8_t _addr, HostI2CDevice *_device)
+{
+    _hostDevices[_addr & 0x7F] = _device;
+}
+
+uint32_t hostGetI2CClock()
+{
+    return _hostClock;
+}
+
+void hostSetIOHook(void (*_hook)(uint8_t _pin, uint8_t _state, void *_arg), void *_arg)
+{
+    _hostIOHook = _hook;
+    _hostIOArg = _arg;
+}
+
+void hostSetDelayHook(void (*_hook)(void *_arg), void *_arg)
+{
+    _hostDelayHook = _hook;
+    _hostDelayArg = _arg;
+}
+
+void hostTriggerInterrupt(int _pin)
+{
+    if (_pin >= 0 && _pin < 64 && _hostIsr[_pin] != NULL) _hostIsr[_pin]();
+}
+
+uint32_t hostGetPartialUpdates()
+{
+    return _hostPartialUpdates;
+}
+
+void hostAdvanceMs(uint32_t _ms)
+{
+    _hostTime += (uint64_t)_ms * 1000;
+}
+
+void hostAdvanceUs(uint32_t _us)
+{
+    _hostTime += _us;
+}
+
+int hostTestResult(const char *_name)
+{
+    if (hostFailures == 0)
+    {
+        printf("%s: PASS\n", _name);
+        return 0;
+    }
+
+    printf("%s: FAIL (%d failed checks)\n", _name, hostFailures);
+    return 1;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Arduino core.
+
+unsigned long millis()
+{
+    return (unsigned long)(_hostTime / 1000);
+}
+
+unsigned long micros()
+{
+    return (unsigned long)_hostTime;
+}
+
+void delay(unsigned long _ms)
+{
+    hostAdvanceMs(_ms);
+    if (_hostDelayHook != NULL) _hostDelayHook(_hostDelayArg);
+}
+
+void delayMicroseconds(unsigned int _us)
+{
+    hostAdvanceUs(_us);
+}
+
+long map(long _x, long _inMin, long _inMax, long _outMin, long _outMax)
+{
+    return (_x - _inMin) * (_outMax - _outMin) / (_inMax - _inMin) + _outMin;
+}
+
+void pinMode(uint8_t _pin, uint8_t _mode)
+{
+}
+
+int digitalPinToInterrupt(int _pin)
+{
+    return _pin;
+}
+
+void attachInterrupt(int _pin, void (*_isr)(), int _mode)
+{
+    if (_pin >= 0 && _pin < 64) _hostIsr[_pin] = _isr;
+}
+
+void detachInterrupt(int _pin)
+{
+    if (_pin >= 0 && _pin < 64) _hostIsr[_pin] = NULL;
+}
+
+void HardwareSerial::begin(unsigned long _baud)
+{
+}
+
+size_t HardwareSerial::print(const char *_str)
+{
+    return fputs(_str, stdout) >= 0 ? strlen(_str) : 0;
+}
+
+size_t HardwareSerial::print(int _value)
+{
+    return ::printf("%d", _value);
+}
+
+size_t HardwareSerial::println()
+{
+    return ::printf("\n");
+}
+
+int HardwareSerial::printf(const char *_format, ...)
+{
+    va_list _args;
+    va_start(_args, _format);
+    int _ret = vprintf(_format, _args);
+    va_end(_args);
+    return _ret;
+}
+
+uint32_t EspClass::getCycleCount()
+{
+    // 240MHz CPU clock.
+    return (uint32_t)(_hostTime * 240);
+}
+
+// ---------------------------------------------------------------------------------------------
+// Wire.
+
+bool TwoWire::begin()
+{
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t _clock)
+{
+    _hostClock = _clock;
+    return true;
+}
+
+void TwoWire::beginTransmission(uint8_t _addr)
+{
+    this->_addr = _addr & 0x7F;
+    _txLen = 0;
+}
+
+size_t TwoWire::write(uint8_t _data)
+{
+    if (_txLen >= sizeof(_txBuffer)) return 0;
+    _txBuffer[_txLen++] = _data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *_data, size_t _len)
+{
+    size_t _n = 0;
+    while (_n < _len && write(_data[_n])) _n++;
+    return _n;
+}
+
+uint8_t TwoWire::endTransmission(bool _sendStop)
+{
+    // Bus time of the transfer (9 clocks per byte with ACK, address byte included).
+    hostAdvanceUs((uint32_t)(((_txLen + 1) * 9 * 1000000ULL) / _hostClock));
+
+    HostI2CDevice *_dev = _hostDevices[_addr];
+    if (_dev == NULL) return 2;
+
+    return _dev->i2cWrite(_txBuffer, _txLen) ? 0 : 3;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t _addr, size_t _len)
+{
+    _rxLen = 0;
+    _rxIndex = 0;
+    if (_len > sizeof(_rxBuffer)) _len = sizeof(_rxBuffer);
+
+    hostAdvanceUs((uint32_t)(((_len + 1) * 9 * 1000000ULL) / _hostClock));
+
+    HostI2CDevice *_dev = _hostDevices[_addr & 0x7F];
+    if (_dev == NULL || !_dev->i2cRead(_rxBuffer, _len)) return 0;
+
+    _rxLen = _len;
+    return _len;
+}
+
+int TwoWire::available()
+{
+    return _rxLen - _rxIndex;
+}
+
+int TwoWire::read()
+{
+    return _rxIndex < _rxLen ? _rxBuffer[_rxIndex++] : -1;
+}
+
+size_t TwoWire::readBytes(uint8_t *_buffer, size_t _len)
+{
+    size_t _n = 0;
+    while (_n < _len && _rxIndex < _rxLen) _buffer[_n++] = _rxBuffer[_rxIndex++];
+    return _n;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Inkplate.
+
+Inkplate::Inkplate(uint8_t _mode)
+{
+}
+
+bool Inkplate::begin()
+{
+    return true;
+}
+
+void Inkplate::pinModeIO(uint8_t _pin, uint8_t _mode, uint8_t _io)
+{
+}
+
+void Inkplate::digitalWriteIO(uint8_t _pin, uint8_t _state, uint8_t _io)
+{
+    if (_hostIOHook != NULL) _hostIOHook(_pin, _state, _hostIOArg);
+}
+
+void Inkplate::clearDisplay()
+{
+}
+
+void Inkplate::display(bool _leaveOn)
+{
+}
+
+void Inkplate::partialUpdate(bool _forced, bool _leaveOn)
+{
+    _hostPartialUpdates++;
+}
+
+void Inkplate::drawPixel(int16_t _x, int16_t _y, uint16_t _color)
+{
+}
+
+void Inkplate::drawLine(int16_t _x0, int16_t _y0, int16_t _x1, int16_t _y1, uint16_t _color)
+{
+}
+
+void Inkplate::drawCircle(int16_t _x, int16_t _y, int16_t _r, uint16_t _color)
+{
+}
+
+void Inkplate::fillRect(int16_t _x, int16_t _y, int16_t _w, int16_t _h, uint16_t _color)
+{
+}
+
+int16_t Inkplate::width()
+{
+    return 1024;
+}
+
+int16_t Inkplate::height()
+{
+    return 758;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Preferences.
+
+bool Preferences::begin(const char *_name, bool _readOnly)
+{
+    strncpy(this->_name, _name, sizeof(this->_name) - 1);
+    return true;
+}
+
+void Preferences::end()
+{
+}
+
+size_t Preferences::putBytes(const char *_key, const void *_value, size_t _len)
+{
+    const uint8_t *_bytes = (const uint8_t *)_value;
+    _hostPrefs[std::string(_name) + "/" + _key] = std::vector<uint8_t>(_bytes, _bytes + _len);
+    return _len;
+}
+
+size_t Preferences::getBytes(const char *_key, void *_buffer, size_t _maxLen)
+{
+    std::map<std::string, std::vector<uint8_t>>::iterator _it = _hostPrefs.find(std::string(_name) + "/" + _key);
+    if (_it == _hostPrefs.end() || _it->second.size() > _maxLen) return 0;
+    memcpy(_buffer, _it->second.data(), _it->second.size());
+    return _it->second.size();
+}
+
+// ---------------------------------------------------------------------------------------------
+// FreeRTOS. Tasks made with xTaskCreate() run to the end right away in the caller's thread. Tasks
+// started with hostStartTask() have their own thread, but only one thread runs at a time: the
+// running one gives the CPU to the next one only when it blocks (cooperative round robin), so the
+// order of events is always the same.
+
+struct hostTask
+{
+    bool done;
+    bool blocked;
+    bool timed;
+    uint32_t notify;
+};
+
+static hostTask _hostMainTask = {false, false, false, 0};
+static std::vector<hostTask *> _hostTasks(1, &_hostMainTask);
+static hostTask *_hostCurrent = &_hostMainTask;
+static thread_local hostTask *_hostSelf = &_hostMainTask;
+
+// Counts blocked tasks that continued and tasks that ended.
+static uint32_t _hostProgress = 0;
+
+// Never destroyed, threads can still wait on them when the test ends.
+static std::mutex *_hostSchedMutex = new std::mutex;
+static std::condition_variable *_hostSchedCv = new std::condition_variable;
+
+// Next task that is not done (round robin, can be the current one).
+static hostTask *hostNextTask()
+{
+    size_t _index = 0;
+    while (_hostTasks[_index] != _hostSelf) _index++;
+
+    for (size_t i = 1; i <= _hostTasks.size(); i++)
+    {
+        hostTask *_task = _hostTasks[(_index + i) % _hostTasks.size()];
+        if (!_task->done) return _task;
+    }
+
+    return _hostSelf;
+}
+
+// Give the CPU to the next task and wait until it comes back.
+static void hostYield()
+{
+    hostTask *_next = hostNextTask();
+    if (_next == _hostSelf) return;
+
+    std::unique_lock<std::mutex> _lock(*_hostSchedMutex);
+    _hostCurrent = _next;
+    _hostSchedCv->notify_all();
+    _hostSchedCv->wait(_lock, [] { return _hostCurrent == _hostSelf; });
+}
+
+// Are all other tasks blocked or done?
+static bool hostOthersBlocked()
+{
+    for (hostTask *_task : _hostTasks)
+    {
+        if (_task != _hostSelf && !_task->done && !_task->blocked) return false;
+    }
+
+    return true;
+}
+
+// Is there other blocked task with the timeout?
+static bool hostOtherTimedWait()
+{
+    for (hostTask *_task : _hostTasks)
+    {
+        if (_task != _hostSelf && !_task->done && _task->blocked && _task->timed) return true;
+    }
+
+    return false;
+}
+
+// Block until _ready() returns true. Other tasks run in the meantime. If nothing can change anymore
+// (all tasks are blocked), wait with the timeout fails (time is advanced by the timeout) and waiting
+// forever is a deadlock (unless other task is going to time out first).
+static bool hostWait(std::function<bool()> _ready, TickType_t _ticks)
+{
+    if (_ready()) return true;
+
+    _hostSelf->blocked = true;
+    _hostSelf->timed = _ticks != portMAX_DELAY;
+
+    while (true)
+    {
+        hostYield();
+        if (_ready()) break;
+
+        if (hostOthersBlocked())
+        {
+            if (_ticks != portMAX_DELAY)
+            {
+                _hostSelf->blocked = false;
+                hostAdvanceMs(_ticks);
+                return false;
+            }
+
+            if (!hostOtherTimedWait())
+            {
+                fflush(stdout);
+                fprintf(stderr, "Deadlock: waiting forever on empty queue, taken semaphore or task notification\n");
+                abort();
+            }
+        }
+    }
+
+    _hostSelf->blocked = false;
+    _hostProgress++;
+    return true;
+}
+
+void hostStartTask(void (*_task)(void *), void *_arg)
+{
+    hostTask *_new = new hostTask{false, false, false, 0};
+    _hostTasks.push_back(_new);
+
+    std::thread([_new, _task, _arg]() {
+        _hostSelf = _new;
+        {
+            std::unique_lock<std::mutex> _lock(*_hostSchedMutex);
+            _hostSchedCv->wait(_lock, [_new] { return _hostCurrent == _new; });
+        }
+
+        _task(_arg);
+
+        // Task has ended, give the CPU to the next one.
+        std::unique_lock<std::mutex> _lock(*_hostSchedMutex);
+        _new->done = true;
+        _hostProgress++;
+        _hostCurrent = hostNextTask();
+        _hostSchedCv->notify_all();
+    }).detach();
+
+    // New task runs right away (until it blocks or ends).
+    std::unique_lock<std::mutex> _lock(*_hostSchedMutex);
+    _hostCurrent = _new;
+    _hostSchedCv->notify_all();
+    _hostSchedCv->wait(_lock, [] { return _hostCurrent == _hostSelf; });
+}
+
+void hostRunTasks()
+{
+    // Every task gets the CPU once per round, stop after the round where nothing has changed.
+    uint32_t _progress;
+    do
+    {
+        _progress = _hostProgress;
+        hostYield();
+    } while (_progress != _hostProgress || !hostOthersBlocked());
+}
+
+struct hostQueue
+{
+    std::deque<std::vector<uint8_t>> items;
+    size_t len;
+    size_t itemSize;
+};
+
+struct hostEventGroup
+{
+    EventBits_t bits;
+};
+
+void portENTER_CRITICAL(portMUX_TYPE *_mux)
+{
+    _mux->count++;
+}
+
+void portEXIT_CRITICAL(portMUX_TYPE *_mux)
+{
+    _mux->count--;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t _len, UBaseType_t _itemSize)
+{
+    hostQueue *_queue = new hostQueue;
+    _queue->len = _len;
+    _queue->itemSize = _itemSize;
+    return _queue;
+}
+
+void vQueueDelete(QueueHandle_t _queue)
+{
+    delete _queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t _queue, const void *_item, TickType_t _ticks)
+{
+    if (_queue->items.size() >= _queue->len) return pdFALSE;
+
+    const uint8_t *_bytes = (const uint8_t *)_item;
+    _queue->items.push_back(std::vector<uint8_t>(_bytes, _bytes + _queue->itemSize));
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t _queue, void *_item, TickType_t _ticks)
+{
+    if (!hostWait([_queue] { return !_queue->items.empty(); }, _ticks)) return pdFALSE;
+
+    if (_item != NULL) memcpy(_item, _queue->items.front().data(), _queue->itemSize);
+    _queue->items.pop_front();
+    return pdTRUE;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    hostQueue *_sem = (hostQueue *)xQueueCreate(1, 0);
+    _sem->items.push_back(std::vector<uint8_t>());
+    return _sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+    return xQueueCreate(1, 0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t _sem, TickType_t _ticks)
+{
+    return xQueueReceive(_sem, NULL, _ticks);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t _sem)
+{
+    return xQueueSend(_sem, NULL, 0);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t _sem)
+{
+    vQueueDelete(_sem);
+}
+
+BaseType_t xTaskCreate(void (*_task)(void *), const char *_name, uint32_t _stack, void *_arg, UBaseType_t _prio, TaskHandle_t *_handle)
+{
+    // Run the task to the end (it deletes itself at the end).
+    _task(_arg);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(void (*_task)(void *), const char *_name, uint32_t _stack, void *_arg, UBaseType_t _prio, TaskHandle_t *_handle, BaseType_t _core)
+{
+    return xTaskCreate(_task, _name, _stack, _arg, _prio, _handle);
+}
+
+void vTaskDelete(TaskHandle_t _task)
+{
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return _hostSelf;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t _task)
+{
+    ((hostTask *)_task)->notify++;
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t _clear, TickType_t _ticks)
+{
+    if (!hostWait([] { return _hostSelf->notify != 0; }, _ticks)) return 0;
+
+    uint32_t _value = _hostSelf->notify;
+    _hostSelf->notify = _clear ? 0 : _value - 1;
+    return _value;
+}
+
+void vTaskDelay(TickType_t _ticks)
+{
+    hostAdvanceMs(_ticks);
+}
+
+EventGroupHandle_t xEventGroupCreate()
+{
+    hostEventGroup *_group = new hostEventGroup;
+    _group->bits = 0;
+    return _group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t _group, EventBits_t _bits)
+{
+    _group->bits |= _bits;
+    return _group->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t _group, EventBits_t _bits)
+{
+    EventBits_t _old = _group->bits;
+    _group->bits &= ~_bits;
+    return _old;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t _group)
+{
+    return _group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t _group, EventBits_t _bits, BaseType_t _clear, BaseType_t _all, TickType_t _ticks)
+{
+    bool _done = hostWait([_group, _bits, _all] { return _all ? (_group->bits & _bits) == _bits : (_group->bits & _bits) != 0; }, _ticks);
+    EventBits_t _ret = _group->bits;
+    if (_done && _clear) _group->bits &= ~_bits;
+    return _ret;
+}
@@ -0,0 +1,70 @@
+#ifndef __HOSTTEST_H__
+#define __HOSTTEST_H__
+
+// Helpers for the host tests of the Cypress touch library (virtual time, emulated I2C devices,
+// I/O expander and interrupt hooks and simple test checks).
+#include <Arduino.h>
+
+// Emulated I2C device. Return false to NACK the transfer.
+class HostI2CDevice
+{
+    public:
+        virtual ~HostI2CDevice() {}
+        virtual bool i2cWrite(const uint8_t *_data, size_t _len) = 0;
+        virtual bool i2cRead(uint8_t *_data, size_t _len) = 0;
+};
+
+// Attach emulated device to the I2C address (NULL - nothing on that address).
+void hostAttachI2C(uint8_t _addr, HostI2CDevice *_device);
+
+// Get I2C clock last set with Wire.setClock().
+uint32_t hostGetI2CClock();
+
+// Function called on every I/O expander pin write (digitalWriteIO()).
+void hostSetIOHook(void (*_hook)(uint8_t _pin, uint8_t _state, void *_arg), void *_arg);
+
+// Function called after every delay() (for example to emulate the user while the library polls).
+void hostSetDelayHook(void (*_hook)(void *_arg), void *_arg);
+
+// Call ISR attached to the GPIO pin (if there is one).
+void hostTriggerInterrupt(int _pin);
+
+// Number of Inkplate partialUpdate() calls.
+uint32_t hostGetPartialUpdates();
+
+// Start task in its own thread. Only one task runs at a time, the CPU is given to the next task
+// only when the running one blocks (FreeRTOS wait) or ends. New task runs right away.
+void hostStartTask(void (*_task)(void *), void *_arg);
+
+// Let the started tasks run until all of them are blocked or ended.
+void hostRunTasks();
+
+// Advance virtual time.
+void hostAdvanceMs(uint32_t _ms);
+void hostAdvanceUs(uint32_t _us);
+
+// Test checks. Failed check is printed and counted, test continues.
+extern int hostFailures;
+
+#define CHECK(_cond) \
+    do { \
+        if (!(_cond)) { \
+            printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #_cond); \
+            hostFailures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(_a, _b) \
+    do { \
+        long long _va = (long long)(_a); \
+        long long _vb = (long long)(_b); \
+        if (_va != _vb) { \
+            printf("%s:%d: CHECK_EQ failed: %s (%lld) != %s (%lld)\n", __FILE__, __LINE__, #_a, _va, #_b, _vb); \
+            hostFailures++; \
+        } \
+    } while (0)
+
+// Print test result and get the exit code.
+int hostTestResult(const char *_name);
+
+#endif
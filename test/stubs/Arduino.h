@@ -0,0 +1,56 @@
+// Host replacement for the Arduino core (only what the Cypress touch library uses).
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define IRAM_ATTR
+
+#define INPUT   0x01
+#define OUTPUT  0x03
+#define LOW     0
+#define HIGH    1
+#define FALLING 0x02
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long _ms);
+void delayMicroseconds(unsigned int _us);
+
+#define constrain(_x, _low, _high)  ((_x) < (_low) ? (_low) : ((_x) > (_high) ? (_high) : (_x)))
+
+long map(long _x, long _inMin, long _inMax, long _outMin, long _outMax);
+
+void pinMode(uint8_t _pin, uint8_t _mode);
+int digitalPinToInterrupt(int _pin);
+void attachInterrupt(int _pin, void (*_isr)(), int _mode);
+void detachInterrupt(int _pin);
+
+class HardwareSerial
+{
+    public:
+        void begin(unsigned long _baud);
+        size_t print(const char *_str);
+        size_t print(int _value);
+        size_t println();
+        int printf(const char *_format, ...);
+};
+
+extern HardwareSerial Serial;
+
+class EspClass
+{
+    public:
+        uint32_t getCycleCount();
+};
+
+extern EspClass ESP;
+
+#include "freertos/FreeRTOS.h"
+
+#endif
@@ -0,0 +1,37 @@
+// Host replacement for the Inkplate library. I/O expander writes go to the emulated devices (see hostTest.h).
+#ifndef __HOST_INKPLATE_H__
+#define __HOST_INKPLATE_H__
+
+#include <Arduino.h>
+
+#define INKPLATE_1BIT   0
+#define INKPLATE_3BIT   1
+
+#define BLACK   1
+#define WHITE   0
+
+#define IO_INT_ADDR 0x20
+#define IO_EXT_ADDR 0x22
+
+#define IO_PIN_B2   10
+#define IO_PIN_B4   12
+
+class Inkplate
+{
+    public:
+        Inkplate(uint8_t _mode);
+        bool begin();
+        void pinModeIO(uint8_t _pin, uint8_t _mode, uint8_t _io = IO_INT_ADDR);
+        void digitalWriteIO(uint8_t _pin, uint8_t _state, uint8_t _io = IO_INT_ADDR);
+        void clearDisplay();
+        void display(bool _leaveOn = false);
+        void partialUpdate(bool _forced = false, bool _leaveOn = false);
+        void drawPixel(int16_t _x, int16_t _y, uint16_t _color);
+        void drawLine(int16_t _x0, int16_t _y0, int16_t _x1, int16_t _y1, uint16_t _color);
+        void drawCircle(int16_t _x, int16_t _y, int16_t _r, uint16_t _color);
+        void fillRect(int16_t _x, int16_t _y, int16_t _w, int16_t _h, uint16_t _color);
+        int16_t width();
+        int16_t height();
+};
+
+#endif
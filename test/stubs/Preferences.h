@@ -0,0 +1,19 @@
+// Host replacement for the ESP32 Preferences library (values are kept in RAM).
+#ifndef __HOST_PREFERENCES_H__
+#define __HOST_PREFERENCES_H__
+
+#include <Arduino.h>
+
+class Preferences
+{
+    public:
+        bool begin(const char *_name, bool _readOnly = false);
+        void end();
+        size_t putBytes(const char *_key, const void *_value, size_t _len);
+        size_t getBytes(const char *_key, void *_buffer, size_t _maxLen);
+
+    private:
+        char _name[16] = {0};
+};
+
+#endif
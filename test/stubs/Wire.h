@@ -0,0 +1,32 @@
+// Host replacement for the Arduino Wire library. Transfers go to the emulated devices (see hostTest.h).
+#ifndef __HOST_WIRE_H__
+#define __HOST_WIRE_H__
+
+#include <Arduino.h>
+
+class TwoWire
+{
+    public:
+        bool begin();
+        bool setClock(uint32_t _clock);
+        void beginTransmission(uint8_t _addr);
+        size_t write(uint8_t _data);
+        size_t write(const uint8_t *_data, size_t _len);
+        uint8_t endTransmission(bool _sendStop = true);
+        uint8_t requestFrom(uint8_t _addr, size_t _len);
+        int available();
+        int read();
+        size_t readBytes(uint8_t *_buffer, size_t _len);
+
+    private:
+        uint8_t _addr = 0;
+        uint8_t _txBuffer[256];
+        size_t _txLen = 0;
+        uint8_t _rxBuffer[256];
+        size_t _rxLen = 0;
+        size_t _rxIndex = 0;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,38 @@
+// Host replacement for FreeRTOS. Tasks are run to the end when they are created. Tests can start
+// cooperative tasks with hostStartTask() (see hostTest.h), blocking calls then let them run. If
+// nothing can change anymore, blocking call with the timeout fails (time is advanced by the timeout)
+// and waiting forever aborts the test.
+#ifndef __HOST_FREERTOS_H__
+#define __HOST_FREERTOS_H__
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t EventBits_t;
+
+typedef struct hostQueue *QueueHandle_t;
+typedef struct hostQueue *SemaphoreHandle_t;
+typedef struct hostEventGroup *EventGroupHandle_t;
+typedef void *TaskHandle_t;
+
+#define portMAX_DELAY   ((TickType_t)0xFFFFFFFF)
+#define pdTRUE          1
+#define pdFALSE         0
+#define pdPASS          1
+#define pdFAIL          0
+#define pdMS_TO_TICKS(x)    ((TickType_t)(x))
+#define tskNO_AFFINITY  0x7FFFFFFF
+
+typedef struct
+{
+    int count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+void portENTER_CRITICAL(portMUX_TYPE *_mux);
+void portEXIT_CRITICAL(portMUX_TYPE *_mux);
+
+#endif
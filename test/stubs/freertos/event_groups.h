@@ -0,0 +1,12 @@
+#ifndef __HOST_FREERTOS_EVENT_GROUPS_H__
+#define __HOST_FREERTOS_EVENT_GROUPS_H__
+
+#include "FreeRTOS.h"
+
+EventGroupHandle_t xEventGroupCreate();
+EventBits_t xEventGroupSetBits(EventGroupHandle_t _group, EventBits_t _bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t _group, EventBits_t _bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t _group);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t _group, EventBits_t _bits, BaseType_t _clear, BaseType_t _all, TickType_t _ticks);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef __HOST_FREERTOS_QUEUE_H__
+#define __HOST_FREERTOS_QUEUE_H__
+
+#include "FreeRTOS.h"
+
+QueueHandle_t xQueueCreate(UBaseType_t _len, UBaseType_t _itemSize);
+void vQueueDelete(QueueHandle_t _queue);
+BaseType_t xQueueSend(QueueHandle_t _queue, const void *_item, TickType_t _ticks);
+BaseType_t xQueueReceive(QueueHandle_t _queue, void *_item, TickType_t _ticks);
+
+#endif
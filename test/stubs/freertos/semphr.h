@@ -0,0 +1,12 @@
+#ifndef __HOST_FREERTOS_SEMPHR_H__
+#define __HOST_FREERTOS_SEMPHR_H__
+
+#include "queue.h"
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateBinary();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t _sem, TickType_t _ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t _sem);
+void vSemaphoreDelete(SemaphoreHandle_t _sem);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef __HOST_FREERTOS_TASK_H__
+#define __HOST_FREERTOS_TASK_H__
+
+#include "FreeRTOS.h"
+
+BaseType_t xTaskCreate(void (*_task)(void *), const char *_name, uint32_t _stack, void *_arg, UBaseType_t _prio, TaskHandle_t *_handle);
+BaseType_t xTaskCreatePinnedToCore(void (*_task)(void *), const char *_name, uint32_t _stack, void *_arg, UBaseType_t _prio, TaskHandle_t *_handle, BaseType_t _core);
+void vTaskDelete(TaskHandle_t _task);
+void vTaskDelay(TickType_t _ticks);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+BaseType_t xTaskNotifyGive(TaskHandle_t _task);
+uint32_t ulTaskNotifyTake(BaseType_t _clear, TickType_t _ticks);
+
+#endif
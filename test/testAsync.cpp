@@ -0,0 +1,105 @@
+// Host test of the background init (beginAsync()): touch can't be used until it's ready, the ready
+// callback and waitReady() report the result and I2C clock is not changed by the init task (it's tuned
+// later, from the application task).
+#include "hostTest.h"
+#include "cypressTouchEmulator.h"
+#include "cypressTouch.h"
+
+// Clock used by the display before the touch init.
+#define DISPLAY_CLOCK   100000
+
+static CypressTouchEmulator emu;
+static Inkplate display(INKPLATE_1BIT);
+static CypressTouch touch;
+
+// Ready callback calls and the last result.
+static int readyCalls = 0;
+static bool readyOk = false;
+
+static void ready(bool _ok, void *_arg)
+{
+    readyCalls++;
+    readyOk = _ok;
+    CHECK(_arg == &touch);
+}
+
+// Application uses the touch while the init task waits.
+static int userCalls = 0;
+
+static void user(void *_arg)
+{
+    if (touch.getState() != CYPRESS_TOUCH_STATE_STARTING) return;
+    userCalls++;
+
+    struct cypressTouchData _data;
+    emu.touch(1, 100, 200, 50);
+    CHECK(!touch.isReady());
+    CHECK(!touch.available());
+    CHECK(!touch.getTouchData(&_data));
+    CHECK(!touch.setPowerMode(CYPRESS_TOUCH_LOW_POWER_MODE));
+
+    // Clock of the whole bus stays the same while the display can use it.
+    CHECK_EQ(hostGetI2CClock(), DISPLAY_CLOCK);
+}
+
+int main()
+{
+    emu.attach();
+    Wire.setClock(DISPLAY_CLOCK);
+
+    // Init runs in the background, application is emulated from the delays of the init task.
+    hostSetDelayHook(user, NULL);
+    CHECK(touch.beginAsync(&Wire, &display, ready, &touch));
+    hostSetDelayHook(NULL, NULL);
+    CHECK(userCalls > 0);
+    CHECK_EQ(readyCalls, 1);
+    CHECK(readyOk);
+    CHECK_EQ(touch.getState(), CYPRESS_TOUCH_STATE_READY);
+
+    // Clock is tuned by waitReady().
+    CHECK_EQ(hostGetI2CClock(), DISPLAY_CLOCK);
+    CHECK(touch.waitReady(1000));
+    CHECK_EQ(hostGetI2CClock(), 400000);
+    CHECK_EQ(touch.getI2CClock(), 400000);
+
+    // Touch works after the init.
+    struct cypressTouchData _data;
+    emu.touch(1, 100, 200, 50);
+    CHECK(touch.available());
+    CHECK(touch.getTouchData(&_data));
+    CHECK_EQ(_data.fingers, 1);
+    CHECK_EQ(_data.x[0], 100);
+    CHECK(touch.setPowerMode(CYPRESS_TOUCH_OPERATE_MODE));
+
+    // Clock is also tuned by the first getTouchData() if waitReady() is not used.
+    touch.end();
+    Wire.setClock(DISPLAY_CLOCK);
+    CHECK(touch.beginAsync(&Wire, &display));
+    CHECK(touch.isReady());
+    CHECK_EQ(hostGetI2CClock(), DISPLAY_CLOCK);
+    emu.touch(1, 300, 400, 50);
+    CHECK(touch.getTouchData(&_data));
+    CHECK_EQ(_data.x[0], 300);
+    CHECK_EQ(hostGetI2CClock(), 400000);
+
+    // Failed init (no controller on the bus) is reported by the callback and waitReady().
+    touch.end();
+    hostAttachI2C(CPYRESS_TOUCH_I2C_ADDR, NULL);
+    Wire.setClock(DISPLAY_CLOCK);
+    readyCalls = 0;
+    userCalls = 0;
+    hostSetDelayHook(user, NULL);
+    CHECK(touch.beginAsync(&Wire, &display, ready, &touch));
+    hostSetDelayHook(NULL, NULL);
+    CHECK(userCalls > 0);
+    CHECK_EQ(readyCalls, 1);
+    CHECK(!readyOk);
+    CHECK_EQ(touch.getState(), CYPRESS_TOUCH_STATE_FAILED);
+    CHECK(!touch.waitReady(1000));
+    CHECK(!touch.available());
+    CHECK(!touch.getTouchData(&_data));
+    CHECK(!touch.setPowerMode(CYPRESS_TOUCH_OPERATE_MODE));
+    CHECK_EQ(hostGetI2CClock(), DISPLAY_CLOCK);
+
+    return hostTestResult("testAsync");
+}
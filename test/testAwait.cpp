@@ -0,0 +1,134 @@
+// Host test of the awaitable touch API (CypressTouchAwait) with a tiny coroutine task type and a
+// scheduler loop, touch events come from the emulated controller through CypressTouchEvents.
+#include <coroutine>
+#include "hostTest.h"
+#include "cypressTouchEmulator.h"
+#include "cypressTouchAwait.h"
+
+static CypressTouchEmulator emu;
+static Inkplate display(INKPLATE_1BIT);
+static CypressTouch touch;
+static CypressTouchEvents events;
+static CypressTouchAwait touchAwait;
+
+// Minimal coroutine task: starts right away, frame is kept after the end until destroy().
+struct Task
+{
+    struct promise_type
+    {
+        Task get_return_object() { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_never initial_suspend() { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { abort(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Scheduler loop: poll until nothing is resumed anymore, return number of resumed coroutines.
+static int schedule()
+{
+    int _total = 0;
+    int _resumed;
+    while ((_resumed = touchAwait.poll()) > 0) _total += _resumed;
+    return _total;
+}
+
+// Counts presses and releases until the given number of taps.
+static int presses = 0;
+static int releases = 0;
+
+static Task tapCounter(int _taps)
+{
+    for (int i = 0; i < _taps; i++)
+    {
+        struct cypressTouchAwaitResult _res = co_await touchAwait.nextPress();
+        if (_res.valid && _res.event.type == CYPRESS_TOUCH_EVENT_PRESS) presses++;
+        _res = co_await touchAwait.nextRelease();
+        if (_res.valid && _res.event.type == CYPRESS_TOUCH_EVENT_RELEASE) releases++;
+    }
+}
+
+// Waits for the touch with the timeout.
+static int timeouts = 0;
+
+static Task timeoutWaiter()
+{
+    struct cypressTouchAwaitResult _res = co_await touchAwait.nextTouch(50);
+    if (!_res.valid) timeouts++;
+}
+
+// Two coroutines waiting for the same press, the first one destroys the second one.
+static std::coroutine_handle<> victim;
+static bool victimResumed = false;
+
+static Task killer()
+{
+    co_await touchAwait.nextPress();
+    victim.destroy();
+}
+
+static Task victimTask()
+{
+    co_await touchAwait.nextPress();
+    victimResumed = true;
+}
+
+static void tap(int _x, int _y)
+{
+    emu.touch(1, _x, _y, 40);
+    schedule();
+    emu.touch(0, 0, 0, 0);
+    schedule();
+}
+
+int main()
+{
+    emu.attach();
+    CHECK(touch.begin(&Wire, &display));
+    CHECK(events.begin(&touch));
+    CHECK(touchAwait.begin(&events));
+
+    // Press and release are delivered to the waiting coroutine.
+    Task _counter = tapCounter(2);
+    CHECK_EQ(schedule(), 0);
+    tap(100, 200);
+    tap(110, 210);
+    CHECK_EQ(presses, 2);
+    CHECK_EQ(releases, 2);
+    CHECK(_counter.handle.done());
+    _counter.handle.destroy();
+
+    // Timeout resumes the coroutine without an event.
+    Task _timeout = timeoutWaiter();
+    delay(20);
+    CHECK_EQ(schedule(), 0);
+    delay(40);
+    CHECK_EQ(schedule(), 1);
+    CHECK_EQ(timeouts, 1);
+    CHECK(_timeout.handle.done());
+    _timeout.handle.destroy();
+
+    // Coroutine destroyed while waiting is removed from the waiting list.
+    Task _destroyed = victimTask();
+    _destroyed.handle.destroy();
+    emu.touch(1, 100, 200, 40);
+    CHECK_EQ(schedule(), 0);
+    emu.touch(0, 0, 0, 0);
+    schedule();
+
+    // Coroutine destroyed by the other coroutine resumed by the same event is not resumed.
+    Task _killer = killer();
+    Task _victim = victimTask();
+    victim = _victim.handle;
+    emu.touch(1, 100, 200, 40);
+    CHECK_EQ(schedule(), 1);
+    CHECK(!victimResumed);
+    CHECK(_killer.handle.done());
+    _killer.handle.destroy();
+    emu.touch(0, 0, 0, 0);
+    schedule();
+
+    return hostTestResult("testAwait");
+}
@@ -0,0 +1,172 @@
+// Host test of the touch library with the I2C bus arbiter (CypressTouchBus): the bus must be free
+// after every transfer, also when the I2C clock is lowered after the errors. Bus is handed over
+// between tasks by the priority (in order of the request for the same priority), the same client
+// used from other task doesn't nest and queued register writes are merged.
+#include "hostTest.h"
+#include "cypressTouchEmulator.h"
+#include "cypressTouch.h"
+
+static CypressTouchEmulator emu;
+static Inkplate display(INKPLATE_1BIT);
+static CypressTouchBus bus;
+static CypressTouch touch;
+
+// Emulated I2C device that remembers the writes.
+class WriteLog : public HostI2CDevice
+{
+    public:
+        int writes = 0;
+        uint8_t last[64];
+        size_t lastLen = 0;
+
+        bool i2cWrite(const uint8_t *_data, size_t _len)
+        {
+            writes++;
+            lastLen = _len;
+            memcpy(last, _data, _len);
+            return true;
+        }
+
+        bool i2cRead(uint8_t *_data, size_t _len)
+        {
+            return false;
+        }
+};
+
+// Task that locks the bus and writes down when it got it.
+struct locker
+{
+    int client;
+    char name;
+    uint32_t timeout;
+    bool locked;
+};
+
+static char order[8];
+static int orderLen = 0;
+
+static void lockTask(void *_arg)
+{
+    struct locker *_l = (struct locker *)_arg;
+    if (!bus.lock(_l->client, _l->timeout)) return;
+
+    _l->locked = true;
+    order[orderLen++] = _l->name;
+    hostAdvanceUs(100);
+    bus.unlock(_l->client);
+}
+
+// Bus is free if other client can take it without waiting.
+static bool busFree(int _client)
+{
+    if (!bus.lock(_client, 0)) return false;
+    bus.unlock(_client);
+    return true;
+}
+
+int main()
+{
+    emu.attach();
+    CHECK(bus.begin(&Wire));
+    CHECK(touch.setBus(&bus));
+    int _display = bus.addClient("display", 1);
+    CHECK(_display >= 0);
+
+    CHECK(touch.begin(&Wire, &display));
+    CHECK(busFree(_display));
+    CHECK_EQ(touch.getI2CClock(), 400000);
+
+    // Controller stops working at 400 kHz, clock is lowered from the transfer and bus is released.
+    emu.maxClock = CYPRESS_TOUCH_I2C_CLOCK_SAFE;
+    struct cypressTouchData _data;
+    for (int i = 0; i <= CYPRESS_TOUCH_I2C_ERR_LIMIT; i++)
+    {
+        emu.touch(1, 100, 200, 50);
+        CHECK(touch.available());
+        touch.getTouchData(&_data);
+        CHECK(busFree(_display));
+    }
+    CHECK_EQ(touch.getI2CClock(), CYPRESS_TOUCH_I2C_CLOCK_SAFE);
+
+    // Touch works at the safe clock.
+    emu.touch(1, 100, 200, 50);
+    CHECK(touch.available());
+    CHECK(touch.getTouchData(&_data));
+    CHECK_EQ(_data.x[0], 100);
+    CHECK(busFree(_display));
+
+    // Touch transfers are counted by the arbiter (touch is the first client).
+    struct cypressTouchBusStats _stats;
+    CHECK(bus.getClientStats(0, &_stats));
+    CHECK(_stats.transactions > 0);
+
+    // Bus is given to the client with the highest priority, then to the clients with the same priority
+    // in order of the request (client D is registered before B, but B asks for the bus first).
+    int _d = bus.addClient("D", CYPRESS_TOUCH_BUS_PRIO_LOW);
+    int _b = bus.addClient("B", CYPRESS_TOUCH_BUS_PRIO_LOW);
+    int _c = bus.addClient("C", CYPRESS_TOUCH_BUS_PRIO_NORMAL + 1);
+    CHECK(_d >= 0 && _b >= 0 && _c >= 0);
+
+    struct locker _lb = {_b, 'B', portMAX_DELAY, false};
+    struct locker _lc = {_c, 'C', portMAX_DELAY, false};
+    struct locker _ld = {_d, 'D', portMAX_DELAY, false};
+    CHECK(bus.lock(_display));
+    hostStartTask(lockTask, &_lb);
+    hostAdvanceMs(1);
+    hostStartTask(lockTask, &_lc);
+    hostAdvanceMs(1);
+    hostStartTask(lockTask, &_ld);
+    hostRunTasks();
+    CHECK_EQ(orderLen, 0);
+    bus.unlock(_display);
+    hostRunTasks();
+    CHECK_EQ(orderLen, 3);
+    CHECK(memcmp(order, "CBD", 3) == 0);
+    CHECK(busFree(_display));
+
+    // Same client from other task is not the owner, it waits until the bus is released.
+    struct locker _le = {_display, 'E', 10, false};
+    CHECK(bus.lock(_display));
+    hostStartTask(lockTask, &_le);
+    hostRunTasks();
+    CHECK(!_le.locked);
+
+    // Unlock from other task that uses the same client doesn't release the bus.
+    CHECK(bus.lock(_display));
+    bus.unlock(_display);
+    hostRunTasks();
+    CHECK(!_le.locked);
+    bus.unlock(_display);
+    hostRunTasks();
+    CHECK(_le.locked);
+    CHECK(busFree(_display));
+
+    // Writes to the consecutive registers are merged into one I2C transaction.
+    WriteLog _dev;
+    hostAttachI2C(0x30, &_dev);
+    uint8_t _regs[] = {0x11, 0x22, 0x33};
+    CHECK(bus.getClientStats(_display, &_stats));
+    uint32_t _merged = _stats.mergedWrites;
+    CHECK(bus.queueWrite(_display, 0x30, 0x10, _regs, 2));
+    CHECK(bus.queueWrite(_display, 0x30, 0x12, _regs + 2, 1));
+    CHECK_EQ(_dev.writes, 0);
+    CHECK(bus.flush(_display));
+    CHECK_EQ(_dev.writes, 1);
+    CHECK_EQ(_dev.lastLen, 4);
+    CHECK(_dev.last[0] == 0x10 && memcmp(_dev.last + 1, _regs, 3) == 0);
+    CHECK(bus.getClientStats(_display, &_stats));
+    CHECK_EQ(_stats.mergedWrites, _merged + 1);
+
+    // Write to other register sends the queued one first.
+    CHECK(bus.queueWrite(_display, 0x30, 0x20, _regs, 1));
+    CHECK(bus.queueWrite(_display, 0x30, 0x40, _regs + 1, 1));
+    CHECK_EQ(_dev.writes, 2);
+    CHECK_EQ(_dev.lastLen, 2);
+    CHECK(bus.flush(_display));
+    CHECK_EQ(_dev.writes, 3);
+    CHECK(_dev.last[0] == 0x40 && _dev.last[1] == 0x22);
+    CHECK(busFree(_display));
+    hostAttachI2C(0x30, NULL);
+
+    return hostTestResult("testBus");
+}
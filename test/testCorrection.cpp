@@ -0,0 +1,129 @@
+// Host test of the edge non-linearity correction (CypressTouchCorrection). Calibration is done with
+// the emulated controller and a touchscreen with a synthetic distortion, then the position error is
+// measured over the whole touchscreen with and without the correction.
+#include <math.h>
+#include "hostTest.h"
+#include "cypressTouchEmulator.h"
+#include "cypressTouchCorrection.h"
+
+static CypressTouchEmulator emu;
+static Inkplate display(INKPLATE_1BIT);
+static CypressTouch touch;
+static CypressTouchCorrection correction;
+
+// Mesh size used for the calibration.
+#define MESH_COLS 7
+#define MESH_ROWS 9
+
+// Synthetic distortion (reported - real position): edges are pulled inwards, with a slight skew.
+static void distort(float _x, float _y, float *_rx, float *_ry)
+{
+    float _u = _x / CYPRESS_TOUCH_MAX_X;
+    float _v = _y / CYPRESS_TOUCH_MAX_Y;
+    float _dx = 28 * sinf(2 * M_PI * _u) * (0.6 + 0.4 * cosf(M_PI * _v)) + 12 * _v;
+    float _dy = 40 * sinf(2 * M_PI * _v) * (0.7 + 0.3 * sinf(M_PI * _u)) - 10 * _u;
+    *_rx = constrain(_x + _dx, 0.0f, (float)CYPRESS_TOUCH_MAX_X);
+    *_ry = constrain(_y + _dy, 0.0f, (float)CYPRESS_TOUCH_MAX_Y);
+}
+
+// Emulated user: taps each calibration target (in the same order as calibrate() shows them)
+// as soon as it's shown with partialUpdate().
+static uint32_t shownTargets = 0;
+static int tapStep = 0;
+static int target = 0;
+
+static void user(void *_arg)
+{
+    if (tapStep == 0)
+    {
+        // Wait for the new target.
+        if (hostGetPartialUpdates() == shownTargets) return;
+        shownTargets = hostGetPartialUpdates();
+    }
+
+    if (tapStep < 3)
+    {
+        // Finger on the target, reported position is distorted.
+        uint16_t _x, _y;
+        float _rx, _ry;
+        correction.getNodePosition(target % MESH_COLS, target / MESH_COLS, &_x, &_y);
+        distort(_x, _y, &_rx, &_ry);
+        emu.touch(1, lroundf(_rx), lroundf(_ry), 40);
+        tapStep++;
+    }
+    else
+    {
+        // Release.
+        emu.touch(0, 0, 0, 0);
+        tapStep = 0;
+        target++;
+    }
+}
+
+// Error statistics over the touchscreen (reported position is corrected if _correct is set).
+static void measure(bool _correct, float *_max, float *_mean)
+{
+    double _sum = 0;
+    int _n = 0;
+    *_max = 0;
+
+    for (int _y = 0; _y <= CYPRESS_TOUCH_MAX_Y; _y += 7)
+    {
+        for (int _x = 0; _x <= CYPRESS_TOUCH_MAX_X; _x += 7)
+        {
+            float _rx, _ry;
+            distort(_x, _y, &_rx, &_ry);
+            uint16_t _px = lroundf(_rx);
+            uint16_t _py = lroundf(_ry);
+            if (_correct) correction.applyPoint(&_px, &_py);
+
+            float _error = hypotf(_px - _x, _py - _y);
+            if (_error > *_max) *_max = _error;
+            _sum += _error;
+            _n++;
+        }
+    }
+
+    *_mean = _sum / _n;
+}
+
+int main()
+{
+    emu.attach();
+    CHECK(touch.begin(&Wire, &display));
+    CHECK(correction.setGrid(MESH_COLS, MESH_ROWS));
+
+    // Calibration with the emulated user.
+    shownTargets = hostGetPartialUpdates();
+    hostSetDelayHook(user, NULL);
+    CHECK(correction.calibrate(&touch, &display, 1024, 758, false, true, true));
+    hostSetDelayHook(NULL, NULL);
+    CHECK_EQ(target, MESH_COLS * MESH_ROWS);
+
+    // Accuracy before and after the correction.
+    float _maxRaw, _meanRaw, _max, _mean;
+    measure(false, &_maxRaw, &_meanRaw);
+    measure(true, &_max, &_mean);
+    printf("Position error: max %.1f mean %.1f without correction, max %.1f mean %.1f with correction\n", _maxRaw, _meanRaw, _max, _mean);
+    CHECK(_max < _maxRaw / 4);
+    CHECK(_mean < _meanRaw / 4);
+
+    // Stored mesh gives the same correction.
+    CHECK(correction.save());
+    CypressTouchCorrection _loaded;
+    CHECK(_loaded.load());
+    for (int i = 0; i < 100; i++)
+    {
+        uint16_t _x = (i * 97) % (CYPRESS_TOUCH_MAX_X + 1), _y = (i * 131) % (CYPRESS_TOUCH_MAX_Y + 1);
+        uint16_t _lx = _x, _ly = _y;
+        correction.applyPoint(&_x, &_y);
+        _loaded.applyPoint(&_lx, &_ly);
+        CHECK_EQ(_lx, _x);
+        CHECK_EQ(_ly, _y);
+    }
+
+    // Calibration without the touch times out.
+    CHECK(!correction.calibrate(&touch, &display, 1024, 758, false, true, true));
+
+    return hostTestResult("testCorrection");
+}
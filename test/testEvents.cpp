@@ -0,0 +1,104 @@
+// Host test of the touch event dispatcher (CypressTouchEvents) with the emulated controller.
+#include "hostTest.h"
+#include "cypressTouchEmulator.h"
+#include "cypressTouchEvents.h"
+
+static CypressTouchEmulator emu;
+static Inkplate display(INKPLATE_1BIT);
+static CypressTouch touch;
+static CypressTouchEvents events;
+
+// Callback subscriber that uses the dispatcher from the callback.
+static int callbackId = -1;
+static int callbackCalls = 0;
+static uint8_t lastType = 0;
+
+static void callback(const struct cypressTouchEvent *_event, void *_arg)
+{
+    callbackCalls++;
+    lastType = _event->type;
+
+    // Stats can be read from the callback.
+    struct cypressTouchDispatchStats _stats;
+    events.getStats(&_stats);
+
+    // Unsubscribe itself on release.
+    if (_event->type == CYPRESS_TOUCH_EVENT_RELEASE) events.unsubscribe(callbackId);
+}
+
+int main()
+{
+    emu.attach();
+    CHECK(touch.begin(&Wire, &display));
+    CHECK(events.begin(&touch));
+
+    int _queueId = events.subscribe(CYPRESS_TOUCH_EVENT_PRESS | CYPRESS_TOUCH_EVENT_RELEASE, 8);
+    callbackId = events.subscribe(CYPRESS_TOUCH_EVENT_ALL, callback, NULL);
+    CHECK(_queueId >= 0);
+    CHECK(callbackId >= 0);
+
+    // Nothing to dispatch without the interrupt.
+    CHECK(!events.dispatch());
+
+    // Press, move, release.
+    emu.touch(1, 10, 20, 30);
+    CHECK(events.dispatch());
+    CHECK_EQ(lastType, CYPRESS_TOUCH_EVENT_PRESS);
+    emu.touch(1, 12, 22, 30);
+    CHECK(events.dispatch());
+    CHECK_EQ(lastType, CYPRESS_TOUCH_EVENT_MOVE);
+    emu.touch(0, 0, 0, 0);
+    CHECK(events.dispatch());
+    CHECK_EQ(lastType, CYPRESS_TOUCH_EVENT_RELEASE);
+    CHECK_EQ(callbackCalls, 3);
+
+    // Another report without fingers (controller can send it after the release) is not a new release.
+    emu.touch(0, 0, 0, 0);
+    CHECK(!events.dispatch());
+    CHECK_EQ(callbackCalls, 3);
+
+    // Callback has unsubscribed, it's not called anymore.
+    emu.touch(1, 10, 20, 30);
+    CHECK(events.dispatch());
+    CHECK_EQ(callbackCalls, 3);
+
+    // Lifting one of two fingers is a release, the next report without fingers is the last release.
+    emu.touch(2, 10, 20, 30, 100, 200, 30);
+    CHECK(events.dispatch());
+    emu.touch(1, 10, 20, 30);
+    CHECK(events.dispatch());
+    emu.touch(0, 0, 0, 0);
+    CHECK(events.dispatch());
+    emu.touch(0, 0, 0, 0);
+    CHECK(!events.dispatch());
+
+    // Queue subscriber got only press and release events.
+    struct cypressTouchEvent _event;
+    CHECK(events.receive(_queueId, &_event, 0));
+    CHECK_EQ(_event.type, CYPRESS_TOUCH_EVENT_PRESS);
+    CHECK_EQ(_event.x[0], 10);
+    CHECK(events.receive(_queueId, &_event, 0));
+    CHECK_EQ(_event.type, CYPRESS_TOUCH_EVENT_RELEASE);
+    CHECK(events.receive(_queueId, &_event, 0));
+    CHECK_EQ(_event.type, CYPRESS_TOUCH_EVENT_PRESS);
+    CHECK(events.receive(_queueId, &_event, 0));
+    CHECK_EQ(_event.type, CYPRESS_TOUCH_EVENT_PRESS);
+    CHECK_EQ(_event.fingers, 2);
+    CHECK(events.receive(_queueId, &_event, 0));
+    CHECK_EQ(_event.type, CYPRESS_TOUCH_EVENT_RELEASE);
+    CHECK_EQ(_event.fingers, 1);
+    CHECK(events.receive(_queueId, &_event, 0));
+    CHECK_EQ(_event.type, CYPRESS_TOUCH_EVENT_RELEASE);
+    CHECK_EQ(_event.fingers, 0);
+    CHECK(!events.receive(_queueId, &_event, 0));
+
+    // Unsubscribed queue can't be used.
+    events.unsubscribe(_queueId);
+    CHECK(!events.receive(_queueId, &_event, 0));
+
+    struct cypressTouchDispatchStats _stats;
+    events.getStats(&_stats);
+    CHECK_EQ(_stats.events, 7);
+
+    return hostTestResult("testEvents");
+}
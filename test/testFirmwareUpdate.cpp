@@ -0,0 +1,165 @@
+// Host test of the firmware update through the bootloader (CypressTouch::updateFirmware()) against
+// the emulated bootloader.
+#include "hostTest.h"
+#include "cypressTouchEmulator.h"
+#include "cypressTouch.h"
+
+static CypressTouchEmulator emu;
+static Inkplate display(INKPLATE_1BIT);
+
+// Firmware image used by all tests (last block is shorter, so padding is tested too).
+static uint8_t image[5 * EMU_BLOCK_SIZE - 20];
+
+// Block number of the first image block in the flash.
+#define FIRST_BLOCK 10
+
+// Injected faults from the progress callback.
+static int failWritesOnBlock = -1;
+static int badChecksumsOnBlock = -1;
+static int badChecksumsCount = 0;
+
+static void progress(uint16_t _block, uint16_t _totalBlocks)
+{
+    // _block blocks are written, inject fault into the next one.
+    if (_block == failWritesOnBlock) emu.failWrites = 1;
+    if (_block == badChecksumsOnBlock) emu.badChecksums = badChecksumsCount;
+}
+
+static void clearFlash()
+{
+    memset(emu.flash, 0xFF, sizeof(emu.flash));
+    memset(emu.written, 0, sizeof(emu.written));
+}
+
+// Check that the whole image (padded with 0xFF) is in the emulated flash.
+static bool imageInFlash()
+{
+    for (unsigned int i = 0; i < sizeof(image); i++)
+    {
+        if (emu.flash[FIRST_BLOCK + i / EMU_BLOCK_SIZE][i % EMU_BLOCK_SIZE] != image[i]) return false;
+    }
+
+    int _blocks = (sizeof(image) + EMU_BLOCK_SIZE - 1) / EMU_BLOCK_SIZE;
+    for (int i = sizeof(image); i < _blocks * EMU_BLOCK_SIZE; i++)
+    {
+        if (emu.flash[FIRST_BLOCK + i / EMU_BLOCK_SIZE][i % EMU_BLOCK_SIZE] != 0xFF) return false;
+    }
+
+    for (int i = 0; i < _blocks; i++)
+    {
+        if (!emu.written[FIRST_BLOCK + i]) return false;
+    }
+
+    return true;
+}
+
+// Controller works after the update (touch report can be read).
+static void checkTouchWorks(CypressTouch *_touch)
+{
+    CHECK(_touch->isReady());
+    CHECK(!emu.inBootloader());
+
+    emu.touch(1, 100, 200, 50);
+    CHECK(_touch->available());
+
+    struct cypressTouchData _data;
+    CHECK(_touch->getTouchData(&_data));
+    CHECK_EQ(_data.fingers, 1);
+    CHECK_EQ(_data.x[0], 100);
+    CHECK_EQ(_data.y[0], 200);
+    CHECK_EQ(_data.z[0], 50);
+}
+
+static void testUpdate()
+{
+    CypressTouch touch;
+    clearFlash();
+    CHECK(touch.begin(&Wire, &display));
+    uint32_t _clock = touch.getI2CClock();
+
+    CHECK(touch.updateFirmware(image, sizeof(image), FIRST_BLOCK, progress));
+    CHECK(imageInFlash());
+    CHECK_EQ(emu.rejectedPackets, 0);
+    checkTouchWorks(&touch);
+
+    // NACKs while the flash is written are expected, they must not lower the I2C clock.
+    struct cypressTouchI2CStats _stats;
+    touch.getI2CStats(&_stats);
+    CHECK_EQ(_stats.fallbacks, 0);
+    CHECK_EQ(touch.getI2CClock(), _clock);
+}
+
+static void testUpdateFromApplication()
+{
+    // Controller starts the application after the reset, so enter bootloader command must be used.
+    emu.autoLaunchApp = true;
+    CypressTouch touch;
+    clearFlash();
+    CHECK(touch.begin(&Wire, &display));
+
+    uint32_t _rejected = emu.rejectedPackets;
+    CHECK(touch.updateFirmware(image, sizeof(image), FIRST_BLOCK));
+    CHECK(imageInFlash());
+    CHECK_EQ(emu.rejectedPackets, _rejected);
+    emu.autoLaunchApp = false;
+}
+
+static void testFailedBlockWrite()
+{
+    // First write of the third block is NACKed, block must be sent again.
+    CypressTouch touch;
+    clearFlash();
+    CHECK(touch.begin(&Wire, &display));
+
+    failWritesOnBlock = 2;
+    CHECK(touch.updateFirmware(image, sizeof(image), FIRST_BLOCK, progress));
+    failWritesOnBlock = -1;
+    CHECK(imageInFlash());
+}
+
+static void testChecksumRetry()
+{
+    // Bootloader rejects the second block twice, it's written on the third try.
+    CypressTouch touch;
+    clearFlash();
+    CHECK(touch.begin(&Wire, &display));
+
+    uint32_t _rejected = emu.rejectedPackets;
+    badChecksumsOnBlock = 1;
+    badChecksumsCount = 2;
+    CHECK(touch.updateFirmware(image, sizeof(image), FIRST_BLOCK, progress));
+    badChecksumsOnBlock = -1;
+    CHECK(imageInFlash());
+    CHECK_EQ(emu.rejectedPackets - _rejected, 2);
+}
+
+static void testChecksumFailure()
+{
+    // Bootloader rejects every try, update must fail.
+    CypressTouch touch;
+    clearFlash();
+    CHECK(touch.begin(&Wire, &display));
+
+    badChecksumsOnBlock = 1;
+    badChecksumsCount = 100;
+    CHECK(!touch.updateFirmware(image, sizeof(image), FIRST_BLOCK, progress));
+    badChecksumsOnBlock = -1;
+    emu.badChecksums = 0;
+    CHECK(!emu.written[FIRST_BLOCK + 1]);
+    CHECK(!emu.written[FIRST_BLOCK + 2]);
+}
+
+int main()
+{
+    for (unsigned int i = 0; i < sizeof(image); i++) image[i] = (i * 37 + 11) & 0xFF;
+
+    emu.attach();
+
+    testUpdate();
+    testUpdateFromApplication();
+    testFailedBlockWrite();
+    testChecksumRetry();
+    testChecksumFailure();
+
+    return hostTestResult("testFirmwareUpdate");
+}
@@ -0,0 +1,119 @@
+// Host test of the heatmap export (CypressTouchHeatmap::exportContext()), including the worst case
+// for the export size, and of the counting (touch downs and dwell intervals, not reports).
+#include "hostTest.h"
+#include "cypressTouchHeatmap.h"
+
+#define CELLS (CYPRESS_TOUCH_HEATMAP_COLS * CYPRESS_TOUCH_HEATMAP_ROWS)
+
+static CypressTouchHeatmap heatmap;
+static uint8_t buffer[CYPRESS_TOUCH_HEATMAP_EXPORT_MAX + 16];
+
+// Raw touch position of the first X and Y position in each cell column and row.
+static uint16_t colX[CYPRESS_TOUCH_HEATMAP_COLS];
+static uint16_t rowY[CYPRESS_TOUCH_HEATMAP_ROWS];
+
+static void findCellPositions()
+{
+    uint32_t _scaleX = ((uint32_t)CYPRESS_TOUCH_HEATMAP_COLS << 16) / (CYPRESS_TOUCH_MAX_X + 1);
+    uint32_t _scaleY = ((uint32_t)CYPRESS_TOUCH_HEATMAP_ROWS << 16) / (CYPRESS_TOUCH_MAX_Y + 1);
+
+    for (int _x = CYPRESS_TOUCH_MAX_X; _x >= 0; _x--) colX[((uint32_t)_x * _scaleX) >> 16] = _x;
+    for (int _y = CYPRESS_TOUCH_MAX_Y; _y >= 0; _y--) rowY[((uint32_t)_y * _scaleY) >> 16] = _y;
+}
+
+// Report one contact in the cell (or no contact if _col is negative).
+static void report(int _col, int _row)
+{
+    struct cypressTouchData _data;
+    memset(&_data, 0, sizeof(_data));
+    _data.fingers = _col >= 0 ? 1 : 0;
+    _data.x[0] = _col >= 0 ? colX[_col] : 0;
+    _data.y[0] = _col >= 0 ? rowY[_row] : 0;
+    heatmap.addReport(&_data);
+}
+
+// Touch the cell _count times (touch down and lift).
+static void touchCell(int _col, int _row, int _count)
+{
+    for (int i = 0; i < _count; i++)
+    {
+        report(_col, _row);
+        report(-1, 0);
+    }
+}
+
+// Decode exported heatmap and compare it with the cells of the context.
+static bool decodeMatches(uint8_t _context, const uint8_t *_data, size_t _len)
+{
+    if (_len < 2 || _data[0] != CYPRESS_TOUCH_HEATMAP_COLS || _data[1] != CYPRESS_TOUCH_HEATMAP_ROWS) return false;
+
+    int _cell = 0;
+    for (size_t i = 2; i < _len; i++)
+    {
+        // Non-zero cell or zero run.
+        uint8_t _value = _data[i];
+        int _run = _value != 0 ? 1 : _data[++i];
+        for (int j = 0; j < _run; j++, _cell++)
+        {
+            if (_cell >= CELLS) return false;
+            if (heatmap.getCell(_context, _cell % CYPRESS_TOUCH_HEATMAP_COLS, _cell / CYPRESS_TOUCH_HEATMAP_COLS) != _value) return false;
+        }
+    }
+
+    return _cell == CELLS;
+}
+
+int main()
+{
+    findCellPositions();
+
+    // Empty heatmap: header and zero runs of 255 cells.
+    size_t _n = heatmap.exportContext(0, buffer, sizeof(buffer));
+    CHECK_EQ(_n, 2 + 2 * ((CELLS + 254) / 255));
+    CHECK(decodeMatches(0, buffer, _n));
+
+    // Worst case: every other cell is touched, starting with the second one (each zero is single).
+    CHECK(heatmap.setContext(1));
+    for (int i = 1; i < CELLS; i += 2) touchCell(i % CYPRESS_TOUCH_HEATMAP_COLS, i / CYPRESS_TOUCH_HEATMAP_COLS, 1 + i % 7);
+    for (int i = 0; i < CELLS; i++) CHECK_EQ(heatmap.getCell(1, i % CYPRESS_TOUCH_HEATMAP_COLS, i / CYPRESS_TOUCH_HEATMAP_COLS), i % 2 ? 1 + i % 7 : 0);
+
+    _n = heatmap.exportContext(1, buffer, CYPRESS_TOUCH_HEATMAP_EXPORT_MAX);
+    CHECK_EQ(_n, CYPRESS_TOUCH_HEATMAP_EXPORT_MAX);
+    CHECK(decodeMatches(1, buffer, _n));
+
+    // Too small buffer.
+    CHECK_EQ(heatmap.exportContext(1, buffer, CYPRESS_TOUCH_HEATMAP_EXPORT_MAX - 1), 0);
+    CHECK_EQ(heatmap.exportContext(CYPRESS_TOUCH_HEATMAP_CONTEXTS, buffer, sizeof(buffer)), 0);
+
+    // Long press (10 s at 100 reports per second) is counted once per dwell interval (first one is the
+    // touch down), not once per report, so the cell doesn't saturate.
+    CHECK(heatmap.setContext(2));
+    for (int i = 0; i < 1000; i++)
+    {
+        report(10, 10);
+        hostAdvanceMs(10);
+    }
+    report(-1, 0);
+    CHECK_EQ(heatmap.getCell(2, 10, 10), 10000 / CYPRESS_TOUCH_HEATMAP_DWELL_MS);
+    struct cypressTouchHeatmapStats _stats;
+    heatmap.getStats(&_stats);
+    CHECK_EQ(_stats.saturated, 0);
+
+    // Swipe over the cells counts each cell once.
+    for (int i = 0; i < 20; i++)
+    {
+        report(20 + i / 4, 5);
+        hostAdvanceMs(10);
+    }
+    report(-1, 0);
+    for (int i = 0; i < 5; i++) CHECK_EQ(heatmap.getCell(2, 20 + i, 5), 1);
+    CHECK_EQ(heatmap.getCell(2, 25, 5), 0);
+
+    // New touch down in the same cell right after the lift is counted.
+    report(10, 10);
+    report(-1, 0);
+    report(10, 10);
+    CHECK_EQ(heatmap.getCell(2, 10, 10), 10000 / CYPRESS_TOUCH_HEATMAP_DWELL_MS + 2);
+
+    return hostTestResult("testHeatmap");
+}
@@ -0,0 +1,85 @@
+// Host driver of the offline prediction evaluation (CypressTouchPredictor::evaluate()). Replays a
+// touch trace (default traces/predictorStrokes.csv, or the file given as the first argument) and
+// prints prediction errors for a few prediction times.
+#include "hostTest.h"
+#include "cypressTouchPredictor.h"
+
+// Max. number of reports loaded from the trace.
+#define TRACE_MAX_LEN 4096
+
+static struct cypressTouchTracePoint trace[TRACE_MAX_LEN];
+
+// Load trace in "timestamp,fingers,x,y" format, lines starting with '#' are comments.
+static int loadTrace(const char *_path)
+{
+    FILE *_f = fopen(_path, "r");
+    if (_f == NULL) return 0;
+
+    int _len = 0;
+    char _line[128];
+    while (_len < TRACE_MAX_LEN && fgets(_line, sizeof(_line), _f))
+    {
+        unsigned int _timestamp, _fingers, _x, _y;
+        if (_line[0] == '#') continue;
+        if (sscanf(_line, "%u,%u,%u,%u", &_timestamp, &_fingers, &_x, &_y) != 4) continue;
+        trace[_len].timestamp = _timestamp;
+        trace[_len].fingers = _fingers;
+        trace[_len].x = _x;
+        trace[_len].y = _y;
+        _len++;
+    }
+
+    fclose(_f);
+    return _len;
+}
+
+int main(int argc, char **argv)
+{
+    const char *_path = argc > 1 ? argv[1] : "traces/predictorStrokes.csv";
+    int _len = loadTrace(_path);
+    CHECK(_len > 0);
+    if (_len == 0) return hostTestResult("testPredictor");
+
+    // Predictor in use: some history and the prediction time that evaluate() must not change.
+    CypressTouchPredictor _predictor;
+    _predictor.setLookahead(40);
+    struct cypressTouchData _report;
+    memset(&_report, 0, sizeof(_report));
+    _report.fingers = 1;
+    for (int i = 0; i < 5; i++)
+    {
+        _report.x[0] = 100 + 10 * i;
+        _report.y[0] = 200 + 5 * i;
+        _predictor.update(&_report, 10 * i);
+    }
+    struct cypressTouchData _before, _after;
+    uint8_t _confidenceBefore[2], _confidenceAfter[2];
+    CHECK(_predictor.predict(&_before, _confidenceBefore));
+
+    // Error table for the trace.
+    printf("Trace %s, %d reports\n", _path, _len);
+    printf("lookahead  samples  mean  max   mean without prediction\n");
+    static const uint16_t _lookaheads[] = {10, 20, 30, 50};
+    for (unsigned int i = 0; i < sizeof(_lookaheads) / sizeof(_lookaheads[0]); i++)
+    {
+        struct cypressTouchPredictionError _result;
+        CHECK(_predictor.evaluate(trace, _len, _lookaheads[i], &_result));
+        printf("%6d ms  %7u  %5.1f %5.1f %5.1f\n", _lookaheads[i], (unsigned int)_result.samples, _result.meanError, _result.maxError, _result.meanErrorNoPrediction);
+
+        // Prediction must be better than just using the last report.
+        CHECK(_result.meanError < _result.meanErrorNoPrediction);
+    }
+
+    // History and prediction time are the same as before the evaluation.
+    CHECK(_predictor.predict(&_after, _confidenceAfter));
+    CHECK_EQ(_after.x[0], _before.x[0]);
+    CHECK_EQ(_after.y[0], _before.y[0]);
+    CHECK_EQ(_confidenceAfter[0], _confidenceBefore[0]);
+
+    // Bad parameters.
+    struct cypressTouchPredictionError _result;
+    CHECK(!_predictor.evaluate(NULL, _len, 30, &_result));
+    CHECK(!_predictor.evaluate(trace, 1, 30, &_result));
+
+    return hostTestResult("testPredictor");
+}
@@ -0,0 +1,159 @@
+// Host test of the touch pressure model (CypressTouchPressure): learned Z range, light touch / hover
+// hysteresis, response curve and packing of the accepted contacts.
+#include "hostTest.h"
+#include "cypressTouchPressure.h"
+
+static CypressTouchPressure pressure;
+static struct cypressTouchPressureData out;
+
+// Process one report.
+static bool report(uint8_t _fingers, uint8_t _z0, uint8_t _z1 = 0)
+{
+    struct cypressTouchData _data;
+    memset(&_data, 0, sizeof(_data));
+    _data.fingers = _fingers;
+    _data.x[0] = 100;
+    _data.y[0] = 200;
+    _data.z[0] = _z0;
+    _data.x[1] = 300;
+    _data.y[1] = 400;
+    _data.z[1] = _z1;
+    return pressure.process(&_data, &out);
+}
+
+// Range is extended right away and shrinks back slowly.
+static void testRange()
+{
+    uint8_t _min, _max;
+    pressure.reset();
+    pressure.getRange(0, &_min, &_max);
+    CHECK_EQ(_min, CYPRESS_TOUCH_PRESSURE_DFLT_Z_MIN);
+    CHECK_EQ(_max, CYPRESS_TOUCH_PRESSURE_DFLT_Z_MAX);
+
+    report(1, 220);
+    report(1, 4);
+    pressure.getRange(0, &_min, &_max);
+    CHECK_EQ(_min, 4);
+    CHECK(_max >= 219);
+
+    // Other channel has its own range.
+    pressure.getRange(1, &_min, &_max);
+    CHECK_EQ(_min, CYPRESS_TOUCH_PRESSURE_DFLT_Z_MIN);
+    CHECK_EQ(_max, CYPRESS_TOUCH_PRESSURE_DFLT_Z_MAX);
+
+    // Many touches in the middle slowly shrink it, but it never goes past them.
+    for (int i = 0; i < 100; i++) report(1, 100);
+    pressure.getRange(0, &_min, &_max);
+    CHECK(_min >= 4 && _min < 10);
+    CHECK(_max > 210);
+    for (int i = 0; i < 20000; i++) report(1, 100);
+    pressure.getRange(0, &_min, &_max);
+    CHECK(_min > 50 && _min <= 100);
+    CHECK(_max >= 100 && _max < 150);
+
+    // New full press after that is the strongest one again.
+    report(0, 0);
+    report(1, 200);
+    CHECK_EQ(out.pressure[0], 255);
+}
+
+// Contact is accepted above the on threshold and suppressed below the off threshold.
+static void testHysteresis()
+{
+    // Linear curve and no smoothing, so pressure is (z - 16) * 255 / 144 with the default range.
+    pressure.reset();
+    CHECK(pressure.setCurve(1.0f));
+    CHECK(pressure.setSmoothing(256));
+    CHECK(pressure.setThresholds(40, 24));
+    CHECK(!pressure.setThresholds(20, 30));
+
+    CHECK(!report(1, 34));
+    CHECK_EQ(out.fingers, 0);
+    CHECK_EQ(out.active, 0);
+    CHECK(report(1, 60));
+    CHECK_EQ(out.fingers, 1);
+    CHECK_EQ(out.active, 1);
+    CHECK(report(1, 32));
+    CHECK(!report(1, 22));
+    CHECK(!report(1, 32));
+    CHECK(report(1, 60));
+
+    // Lifted contact starts from scratch.
+    CHECK(!report(0, 0));
+    CHECK(!report(1, 32));
+}
+
+// Response curve from the gamma and from the lookup table.
+static void testCurve()
+{
+    // Normalised Z of 64 with the range 0 - 255.
+    pressure.reset();
+    CHECK(pressure.setSmoothing(256));
+    CHECK(pressure.setThresholds(0, 0));
+    report(1, 0);
+    report(1, 255);
+
+    CHECK(pressure.setCurve(0.5f));
+    report(1, 64);
+    CHECK(out.pressure[0] >= 127 && out.pressure[0] <= 128);
+    CHECK(pressure.setCurve(2.0f));
+    report(1, 64);
+    CHECK(out.pressure[0] >= 15 && out.pressure[0] <= 16);
+    CHECK(!pressure.setCurve(0.0f));
+
+    uint8_t _lut[CYPRESS_TOUCH_PRESSURE_LUT_SIZE];
+    for (int i = 0; i < CYPRESS_TOUCH_PRESSURE_LUT_SIZE; i++) _lut[i] = 255 - i;
+    CHECK(pressure.setCurve(_lut));
+    report(1, 64);
+    CHECK(out.pressure[0] >= 190 && out.pressure[0] <= 192);
+    CHECK(!pressure.setCurve((const uint8_t *)NULL));
+
+    // Smoothing moves a quarter of the way from 64 to 255.
+    CHECK(pressure.setCurve(1.0f));
+    CHECK(pressure.setSmoothing(64));
+    report(1, 255);
+    CHECK(out.pressure[0] >= 108 && out.pressure[0] <= 113);
+}
+
+// Hovering contact is suppressed, accepted ones are packed into the first slots.
+static void testHover()
+{
+    pressure.reset();
+    CHECK(pressure.setCurve(1.0f));
+    CHECK(pressure.setSmoothing(256));
+    CHECK(pressure.setThresholds(40, 24));
+
+    // First channel hovers, second is pressed.
+    CHECK(report(2, 20, 120));
+    CHECK_EQ(out.fingers, 1);
+    CHECK_EQ(out.active, 2);
+    CHECK_EQ(out.x[0], 300);
+    CHECK_EQ(out.y[0], 400);
+    CHECK(out.pressure[0] > 150);
+    CHECK_EQ(out.x[1], 0);
+    CHECK_EQ(out.pressure[1], 0);
+
+    // Both are pressed.
+    CHECK(report(2, 120, 100));
+    CHECK_EQ(out.fingers, 2);
+    CHECK_EQ(out.active, 3);
+    CHECK_EQ(out.x[0], 100);
+    CHECK_EQ(out.x[1], 300);
+
+    // Both hover.
+    CHECK(!report(2, 18, 18));
+    CHECK_EQ(out.fingers, 0);
+    CHECK_EQ(out.active, 0);
+
+    CHECK(!pressure.process(NULL, &out));
+}
+
+int main()
+{
+    testRange();
+    testHysteresis();
+    testCurve();
+    testHover();
+
+    return hostTestResult("testPressure");
+}
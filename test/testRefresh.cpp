@@ -0,0 +1,114 @@
+// Host test of the touch-driven refresh scheduler (CypressTouchRefresh): rectangle merging and
+// refresh stats.
+#include "hostTest.h"
+#include "cypressTouchRefresh.h"
+
+static Inkplate display(INKPLATE_1BIT);
+
+// Rectangles received by the region callback.
+static struct cypressTouchRect regions[CYPRESS_TOUCH_REFRESH_MAX_RECTS];
+static int regionCount = 0;
+
+static void regionCallback(const struct cypressTouchRect *_rect, void *_arg)
+{
+    if (regionCount < CYPRESS_TOUCH_REFRESH_MAX_RECTS) regions[regionCount] = *_rect;
+    regionCount++;
+}
+
+// Same check as the scheduler uses for merging.
+static bool near(const struct cypressTouchRect *_a, const struct cypressTouchRect *_b)
+{
+    int _gap = CYPRESS_TOUCH_REFRESH_MERGE_GAP;
+    return !(_a->x > _b->x + _b->w + _gap || _b->x > _a->x + _a->w + _gap || _a->y > _b->y + _b->h + _gap || _b->y > _a->y + _a->h + _gap);
+}
+
+static void testPartialUpdateArea()
+{
+    // Without the region callback whole screen is refreshed, so that is the refreshed area.
+    CypressTouchRefresh _refresh;
+    CHECK(_refresh.begin(&display, 0));
+    uint32_t _updates = hostGetPartialUpdates();
+
+    _refresh.addRegion(10, 10, 20, 20);
+    _refresh.addRegion(500, 500, 20, 20);
+    CHECK_EQ(_refresh.getRegionCount(), 2);
+    CHECK(_refresh.tick());
+    CHECK_EQ(hostGetPartialUpdates() - _updates, 1);
+    CHECK(!_refresh.tick());
+
+    _refresh.endInteraction();
+    struct cypressTouchRefreshStats _stats;
+    _refresh.getStats(&_stats);
+    CHECK_EQ(_stats.refreshes, 1);
+    CHECK_EQ(_stats.area, display.width() * display.height());
+    CHECK_EQ(_stats.lastInteractionArea, display.width() * display.height());
+}
+
+static void testRegionCallbackArea()
+{
+    // With the region callback only the dirty rectangles are refreshed.
+    CypressTouchRefresh _refresh;
+    CHECK(_refresh.begin(&display, 0));
+    _refresh.setRegionCallback(regionCallback);
+    regionCount = 0;
+
+    _refresh.addRegion(10, 10, 20, 20);
+    _refresh.addRegion(500, 500, 20, 20);
+
+    // Clipped to (0, 0, 5, 5) and merged with the first one into (0, 0, 30, 30).
+    _refresh.addRegion(-5, -5, 10, 10);
+    CHECK_EQ(_refresh.getRegionCount(), 2);
+    CHECK(_refresh.flush());
+    CHECK_EQ(regionCount, 2);
+
+    struct cypressTouchRefreshStats _stats;
+    _refresh.getStats(&_stats);
+    CHECK_EQ(_stats.refreshes, 2);
+    CHECK_EQ(_stats.area, 30 * 30 + 20 * 20);
+}
+
+static void testForcedMerge()
+{
+    CypressTouchRefresh _refresh;
+    CHECK(_refresh.begin(&display, 0));
+    _refresh.setRegionCallback(regionCallback);
+    regionCount = 0;
+
+    // A and B are the cheapest pair for the forced merge. C is not near A or B, but it's near the
+    // rectangle made from them.
+    _refresh.addRegion(0, 0, 10, 10);
+    _refresh.addRegion(30, 0, 10, 10);
+    _refresh.addRegion(19, 15, 2, 2);
+
+    // Far apart rectangles fill the list, the last one forces the merge.
+    for (int i = 0; i < 5; i++) _refresh.addRegion(100 + 200 * i, 400, 10, 10);
+    CHECK_EQ(_refresh.getRegionCount(), CYPRESS_TOUCH_REFRESH_MAX_RECTS);
+    _refresh.addRegion(500, 700, 10, 10);
+
+    // A + B is merged with C too.
+    CHECK_EQ(_refresh.getRegionCount(), CYPRESS_TOUCH_REFRESH_MAX_RECTS - 1);
+    CHECK(_refresh.flush());
+    CHECK_EQ(regionCount, CYPRESS_TOUCH_REFRESH_MAX_RECTS - 1);
+
+    // No pending rectangles are near each other.
+    for (int a = 0; a < regionCount; a++)
+    {
+        for (int b = a + 1; b < regionCount; b++) CHECK(!near(&regions[a], &regions[b]));
+    }
+
+    bool _found = false;
+    for (int i = 0; i < regionCount; i++)
+    {
+        if (regions[i].x == 0 && regions[i].y == 0 && regions[i].w == 40 && regions[i].h == 17) _found = true;
+    }
+    CHECK(_found);
+}
+
+int main()
+{
+    testPartialUpdateArea();
+    testRegionCallbackArea();
+    testForcedMerge();
+
+    return hostTestResult("testRefresh");
+}
@@ -0,0 +1,203 @@
+// Host test of the stroke capture (CypressTouchStrokes): simplification error of strokes that turn
+// back, point reduction on a dense trace and serialization.
+#include <math.h>
+#include <vector>
+#include "hostTest.h"
+#include "cypressTouchStrokes.h"
+
+static CypressTouchStrokes strokes;
+
+typedef std::vector<struct cypressTouchPoint> Points;
+
+// Distance from the point to the segment.
+static float segmentDistance(struct cypressTouchPoint _p, struct cypressTouchPoint _a, struct cypressTouchPoint _b)
+{
+    float _sx = (float)_b.x - _a.x, _sy = (float)_b.y - _a.y;
+    float _px = (float)_p.x - _a.x, _py = (float)_p.y - _a.y;
+    float _len = _sx * _sx + _sy * _sy;
+    float _t = _len > 0 ? (_px * _sx + _py * _sy) / _len : 0;
+    _t = _t < 0 ? 0 : (_t > 1 ? 1 : _t);
+    return hypotf(_px - _t * _sx, _py - _t * _sy);
+}
+
+// Draw one stroke (press, all points, release) and get max. distance of the reported points from
+// the stored stroke.
+static float drawStroke(const Points &_points)
+{
+    struct cypressTouchData _data;
+    memset(&_data, 0, sizeof(_data));
+    _data.fingers = 1;
+    for (const struct cypressTouchPoint &_p : _points)
+    {
+        _data.x[0] = _p.x;
+        _data.y[0] = _p.y;
+        CHECK(strokes.addReport(&_data));
+    }
+    _data.fingers = 0;
+    CHECK(strokes.addReport(&_data));
+
+    const struct cypressTouchPoint *_stored;
+    uint16_t _count;
+    if (!strokes.getStroke(strokes.getStrokeCount() - 1, &_stored, &_count)) return INFINITY;
+
+    float _maxError = 0;
+    for (const struct cypressTouchPoint &_p : _points)
+    {
+        float _error = _count == 1 ? segmentDistance(_p, _stored[0], _stored[0]) : INFINITY;
+        for (int i = 0; i + 1 < _count; i++)
+        {
+            float _d = segmentDistance(_p, _stored[i], _stored[i + 1]);
+            if (_d < _error) _error = _d;
+        }
+        if (_error > _maxError) _maxError = _error;
+    }
+
+    return _maxError;
+}
+
+// Straight line from (x0, y0) to (x1, y1) with a point every _step units.
+static void line(Points *_points, int _x0, int _y0, int _x1, int _y1, float _step)
+{
+    float _len = hypotf(_x1 - _x0, _y1 - _y0);
+    int _n = _len / _step;
+    for (int i = 0; i <= _n; i++)
+    {
+        float _t = _n ? (float)i / _n : 0;
+        _points->push_back({(uint16_t)lroundf(_x0 + (_x1 - _x0) * _t), (uint16_t)lroundf(_y0 + (_y1 - _y0) * _t)});
+    }
+}
+
+static void testReversal()
+{
+    // Strokes that go forward and turn back on the same line, the tip must be kept.
+    strokes.clear();
+    strokes.setTolerance(2, 0);
+
+    Points _short;
+    line(&_short, 100, 500, 200, 500, 5);
+    line(&_short, 200, 500, 150, 500, 5);
+    float _error = drawStroke(_short);
+    printf("Reversal 100 -> 200 -> 150: max error %.1f\n", _error);
+    CHECK(_error <= 2);
+
+    Points _long;
+    line(&_long, 100, 500, 400, 500, 5);
+    line(&_long, 400, 500, 150, 500, 5);
+    _error = drawStroke(_long);
+    printf("Reversal 100 -> 400 -> 150: max error %.1f\n", _error);
+    CHECK(_error <= 2);
+
+    // Tip (400, 500) is stored.
+    const struct cypressTouchPoint *_stored;
+    uint16_t _count;
+    CHECK(strokes.getStroke(1, &_stored, &_count));
+    bool _tip = false;
+    for (int i = 0; i < _count; i++) if (_stored[i].x == 400 && _stored[i].y == 500) _tip = true;
+    CHECK(_tip);
+}
+
+static void testZigZag()
+{
+    // Zig-zag with sharp turns in both directions.
+    strokes.clear();
+    strokes.setTolerance(2, 0);
+
+    Points _points;
+    for (int i = 0; i < 8; i++) line(&_points, 100 + 40 * i, i % 2 ? 300 : 200, 140 + 40 * i, i % 2 ? 200 : 300, 3);
+    float _error = drawStroke(_points);
+    printf("Zig-zag: max error %.1f\n", _error);
+    CHECK(_error <= 2);
+
+    // Default min. distance filter adds its distance to the bound.
+    strokes.clear();
+    strokes.setTolerance(CYPRESS_TOUCH_STROKE_DFLT_TOLERANCE, CYPRESS_TOUCH_STROKE_DFLT_MIN_DIST);
+    _error = drawStroke(_points);
+    CHECK(_error <= CYPRESS_TOUCH_STROKE_DFLT_TOLERANCE + CYPRESS_TOUCH_STROKE_DFLT_MIN_DIST);
+}
+
+static void testReduction()
+{
+    // Dense handwriting-like trace: loops and curves with a report every ~1.5 - 3 units.
+    strokes.clear();
+    strokes.setTolerance(CYPRESS_TOUCH_STROKE_DFLT_TOLERANCE, CYPRESS_TOUCH_STROKE_DFLT_MIN_DIST);
+
+    float _maxError = 0;
+    for (int s = 0; s < 6; s++)
+    {
+        Points _points;
+        for (float t = 0; t < 2 * M_PI; t += 0.02)
+        {
+            float _x = 100 + 80 * s + 60 * t + 25 * sinf(3 * t);
+            float _y = 300 + 150 * sinf(t + s) + 20 * cosf(2 * t);
+            _points.push_back({(uint16_t)lroundf(_x), (uint16_t)lroundf(_y)});
+        }
+        float _error = drawStroke(_points);
+        if (_error > _maxError) _maxError = _error;
+    }
+
+    uint32_t _reported, _stored;
+    strokes.getPointCount(&_reported, &_stored);
+    printf("Dense trace: %u reported points, %u stored (%.1fx), max error %.1f\n", (unsigned int)_reported, (unsigned int)_stored, (float)_reported / _stored, _maxError);
+    CHECK(_reported >= 10 * _stored);
+    CHECK(_maxError <= CYPRESS_TOUCH_STROKE_DFLT_TOLERANCE + CYPRESS_TOUCH_STROKE_DFLT_MIN_DIST);
+}
+
+// Read variable length number (format of CypressTouchStrokes::serialize()).
+static uint32_t readVarint(const uint8_t *_buffer, int *_index)
+{
+    uint32_t _value = 0;
+    int _shift = 0;
+    uint8_t _byte;
+    do
+    {
+        _byte = _buffer[(*_index)++];
+        _value |= (uint32_t)(_byte & 0x7F) << _shift;
+        _shift += 7;
+    } while (_byte & 0x80);
+
+    return _value;
+}
+
+static void testSerialize()
+{
+    // Strokes from the previous test are packed and unpacked.
+    static uint8_t _buffer[8192];
+    int _len = strokes.serialize(_buffer, sizeof(_buffer));
+    CHECK(_len > 0);
+
+    int _index = 0;
+    int _strokeCount = readVarint(_buffer, &_index);
+    CHECK_EQ(_strokeCount, strokes.getStrokeCount());
+    for (int i = 0; i < _strokeCount && i < strokes.getStrokeCount(); i++)
+    {
+        const struct cypressTouchPoint *_stored;
+        uint16_t _count;
+        CHECK(strokes.getStroke(i, &_stored, &_count));
+        CHECK_EQ(readVarint(_buffer, &_index), _count);
+
+        int32_t _x = 0, _y = 0;
+        for (int j = 0; j < _count; j++)
+        {
+            uint32_t _dx = readVarint(_buffer, &_index);
+            uint32_t _dy = readVarint(_buffer, &_index);
+            _x += (int32_t)(_dx >> 1) ^ -(int32_t)(_dx & 1);
+            _y += (int32_t)(_dy >> 1) ^ -(int32_t)(_dy & 1);
+            CHECK_EQ(_x, _stored[j].x);
+            CHECK_EQ(_y, _stored[j].y);
+        }
+    }
+    CHECK_EQ(_index, _len);
+
+    // Too small buffer.
+    CHECK_EQ(strokes.serialize(_buffer, _len - 1), 0);
+}
+
+int main()
+{
+    testReversal();
+    testZigZag();
+    testReduction();
+    testSerialize();
+
+    return hostTestResult("testStrokes");
+}
@@ -0,0 +1,44 @@
+#!/bin/sh
+# Build cypressTouchArduinoTest with each build profile (minimal, standard, diagnostic) and print
+# text/data/bss of the touch library object files and of the whole firmware image.
+#
+# Needs arduino-cli with the Inkplate board definitions and the Inkplate library installed.
+# Board and size tool can be changed with FQBN and SIZE environment variables, for example:
+# FQBN=Inkplate_Boards:esp32:Inkplate6V2 ./tools/footprintReport.sh
+
+FQBN=${FQBN:-Inkplate_Boards:esp32:Inkplate6}
+SIZE=${SIZE:-xtensa-esp32-elf-size}
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+SKETCH="$ROOT/cypressTouchArduinoTest"
+BUILD="$ROOT/_footprint_build"
+mkdir -p "$BUILD"
+
+for PROFILE in 0 1 2
+do
+    case $PROFILE in
+        0) NAME=minimal ;;
+        1) NAME=standard ;;
+        2) NAME=diagnostic ;;
+    esac
+
+    OUT="$BUILD/$NAME"
+
+    # Compile the sketch with selected profile.
+    if ! arduino-cli compile --fqbn "$FQBN" --build-path "$OUT" \
+        --build-property "compiler.cpp.extra_flags=-DCYPRESS_TOUCH_PROFILE=$PROFILE" \
+        "$SKETCH" > "$OUT.log" 2>&1
+    then
+        echo "Build of the $NAME profile failed, see $OUT.log"
+        exit 1
+    fi
+
+    echo "Profile: $NAME"
+
+    # Library object files (what is compiled in).
+    $SIZE -t "$OUT"/sketch/cypressTouch*.cpp.o | sed 's|[^ \t]*/sketch/||'
+
+    # Whole image (what is linked in, unused functions are removed by the linker).
+    $SIZE "$OUT"/*.ino.elf | sed 's|[^ \t]*/||'
+    echo
+done